@@ -15,79 +15,715 @@
 /* (c) Tim Holyoake, 10th May 2020.                                           */
 /*                                                                            */
 /******************************************************************************/
-#include "lcd44780.h"
-
-/* 44780 LCD library error codes */
-
-#define ROWTOOLOW       -1000   // Row specified as lower than ORIGIN
-#define ROWTOOHIGH      -1001   // Page specified as higher than lcdrows+ORIGIN
-#define COLOUTOFRANGE   -1002   // Column is lower than ORIGIN or higher than ORIGIN+lcdcols
-#define COLTOOLOW       -1003   // Column specified as lower than ORIGIN
-#define COLTOOHIGH      -1004   // Column specified as higher than lcdcols+ORIGIN
-
-/* 44780 LCD general definitions */
-
-#define ORIGIN          1       // Defines the origin point for the library.
-                                // Default is 1 - top line of the display, and
-                                // also for the first character of any line to make
-                                // the library a little more FORTRAN friendly.
-                                // It should work with ORIGIN=0 (or any other value)
-                                // but this is untested.
-
-/* 44780 LCD (HD44780U) instruction set */
-
-#define CLEARDISPLAY            0x01
-#define CURSORHOME              0x02
-#define ENTRYMODESET            0x04
-#define DISPLAYCONTROL          0x08
-#define CURSORMOVE              0x10
-#define FUNCTIONSET             0x20
-#define CGRAMSETADDR            0x40
-#define DDRAMSETADDR            0x80
-
-/* 44780 LCD (HD44780U) instruction set flags */
-
-// Combined with ENTRYMODESET instruction (bitwise or required)
-#define ENTRYDEC                0x00
-#define ENTRYINC                0x01
-#define ENTRYRIGHT              0x00
-#define ENTRYLEFT               0x02
-// Combined with DISPLAYCONTROL instruction (bitwise or required)
-#define BLINKOFF                0x00
-#define BLINKON                 0x01
-#define CURSOROFF               0x00
-#define CURSORON                0x02
-#define DISPLAYOFF              0x00
-#define DISPLAYON               0x04
-// Combined with CURSORMOVE instuction (bitwise or required)
-#define GOLEFT                  0x00
-#define GORIGHT                 0x04
-#define GOCURSOR                0x00
-#define GODISPLAY               0x08
-// Combined with FUNCTIONSET instruction (bitwise or required)
-#define CHAR5X8                 0x00
-#define CHAR5X10                0x04
-#define ONELINE                 0x00
-#define TWOLINE                 0x08
-#define FOURBIT                 0x00
-#define EIGHTBIT                0x10
-
-// Other pins (used by the PCF8574 backpack)
-#define BACKLIGHT               0x08
-#define ENABLE                  0x04
-#define READWRITE               0x02
-#define REGISTERSET             0x01
-
+#include "lcd44780int.h"
+#include "lcd44780rec.h"
 
 // 44780 LCD global variables;
 
-static char bl44780=BACKLIGHT;  			// LCD backlight on (0x08) or off (0x00).
-static uint8_t lcdrows;					// Number of rows on the LCD (1,2 or 4, typically)
-static uint8_t lcdcols;					// Number of columns on the LCD (16 or 20 typically)
+static lcd44780dev *lcddevs[MAXDEVS];			// State for each display in use
+static lcd44780dev *lastdev;				// Most recently used display
 static uint8_t rowstart[4]={0x00, 0x40, 0x14, 0x54}; 	// Addresses for the start of each row
 
+static lcd44780pinmap pcf8574=LCD44780PINSPCF8574;	// Wiring used unless told otherwise
+
+static void lcd44780track(lcd44780dev *dev, uint8_t rs, uint8_t data);
+
+#ifdef _SDT_HAS_SEMAPHORES
+PROBESEMAPHORE(enqueue);				// Set by a tracer while it's attached
+PROBESEMAPHORE(dequeue);
+PROBESEMAPHORE(write);
+PROBESEMAPHORE(sleep);
+PROBESEMAPHORE(commit);
+PROBESEMAPHORE(glyph);
+PROBESEMAPHORE(op);
+#endif
+
 /* HD44780U internal library functions */
 
+lcd44780dev *lcd44780getdev(int pi, int fd, int create) {
+/******************************************************************************/
+/*                                                                            */
+/* Find the state kept for the display on pigpiod connection pi, I2C handle   */
+/* fd. If there is none and create is non zero, new state is allocated with   */
+/* the backlight on and the address counter unknown.                          */
+/*                                                                            */
+/* Returns NULL if the display is not known and can't be added.               */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	int count,slot=-1;
+	lcd44780dev *dev;
+
+	if ((lastdev != NULL) && (lastdev->pi == pi) && (lastdev->fd == fd)) return(lastdev);
+
+	for (count=0;count<MAXDEVS;count++) {
+		dev=lcddevs[count];
+		if (dev == NULL) {
+			if (slot < 0) slot=count;
+		}
+		else if ((dev->pi == pi) && (dev->fd == fd)) {
+			lastdev=dev;
+			return(dev);
+		}
+	}
+
+	if ((create == 0) || (slot < 0)) return(NULL);
+
+	dev=calloc(1,sizeof(lcd44780dev));
+	if (dev == NULL) return(NULL);
+
+	dev->pi=pi;
+	dev->fd=fd;
+	dev->drv=&lcd44780pcf8574drv;
+	dev->backpack=LCD44780PCF8574;
+	dev->blon=1;
+	dev->rgb=RGBALL;
+	dev->inc=1;
+	dev->ac=ACUNKNOWN;
+	memset(dev->ddram,' ',DDRAMSIZE);
+	memset(dev->fb,' ',DDRAMSIZE);
+	memset(dev->barglyph,-1,sizeof(dev->barglyph));
+	memset(dev->bigglyph,-1,sizeof(dev->bigglyph));
+	memset(dev->synth,-1,sizeof(dev->synth));
+	lcd44780mappins(dev,&pcf8574);
+
+	__atomic_store_n(&lcddevs[slot],dev,__ATOMIC_RELEASE);	// Complete before lcd44780finddev sees it
+	lastdev=dev;
+	return(dev);
+}
+
+lcd44780dev *lcd44780finddev(int pi, int fd) {
+/******************************************************************************/
+/*                                                                            */
+/* Find the state kept for the display on pigpiod connection pi, I2C handle   */
+/* fd, without using or changing the most recently used display, and never    */
+/* adding state for it - so it can be called from a thread other than the     */
+/* one using the display.                                                     */
+/*                                                                            */
+/* Returns NULL if the display is not known.                                  */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	int count;
+	lcd44780dev *dev;
+
+	for (count=0;count<MAXDEVS;count++) {
+		dev=__atomic_load_n(&lcddevs[count],__ATOMIC_ACQUIRE);
+		if ((dev != NULL) && (dev->pi == pi) && (dev->fd == fd)) return(dev);
+	}
+	return(NULL);
+}
+
+void lcd44780mappins(lcd44780dev *dev, lcd44780pinmap *map) {
+/******************************************************************************/
+/*                                                                            */
+/* Take on a backpack wiring: work out the bits to send for each data nibble, */
+/* the control lines and the backlight, then rebuild the strobe table.        */
+/* The map must already have been checked.                                    */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	int count;
+
+	dev->pins=*map;
+	dev->rsbit=1<<map->rs;
+	dev->enbit=1<<map->en;
+	dev->blbit=1<<map->bl;
+
+	for (count=0;count<16;count++) {
+		dev->nibble[count]=((count&0x01) ? 1<<map->d4 : 0x00)|
+				   ((count&0x02) ? 1<<map->d5 : 0x00)|
+				   ((count&0x04) ? 1<<map->d6 : 0x00)|
+				   ((count&0x08) ? 1<<map->d7 : 0x00);
+	}
+
+	if ((map->d4 == 4) && (map->d5 == 5) && (map->d6 == 6) && (map->d7 == 7)) dev->layout=LAYOUTHIGH;
+	else if ((map->d4 == 0) && (map->d5 == 1) && (map->d6 == 2) && (map->d7 == 3)) dev->layout=LAYOUTLOW;
+	else dev->layout=LAYOUTOTHER;
+
+	if ((dev->blon && (dev->rgb & RGBBLUE))^map->blinvert) dev->bl=dev->blbit;
+	else dev->bl=0x00;
+
+	lcd44780buildstrobes(dev);
+	return;
+}
+
+void lcd44780buildstrobes(lcd44780dev *dev) {
+/******************************************************************************/
+/*                                                                            */
+/* Fill in the display's strobe table: for every byte and both registers, the */
+/* four bytes to send - high nibble with enable high, then low, then the low  */
+/* nibble the same way - with the backlight and register set bits included.   */
+/* Only needs doing again when the backlight setting or wiring changes.       */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	int rs,data;
+	uint8_t high,low,flags;
+
+	for (rs=0;rs<2;rs++) {
+		flags=dev->bl|((rs) ? dev->rsbit : 0x00);
+		for (data=0;data<256;data++) {
+			high=dev->nibble[data>>4]|flags;
+			low=dev->nibble[data&0x0F]|flags;
+			dev->strobes[rs][data][0]=high|dev->enbit;
+			dev->strobes[rs][data][1]=high;
+			dev->strobes[rs][data][2]=low|dev->enbit;
+			dev->strobes[rs][data][3]=low;
+		}
+	}
+	return;
+}
+
+int lcd44780flush(lcd44780dev *dev) {
+/******************************************************************************/
+/*                                                                            */
+/* Send everything queued for the display in a single write to the bus.       */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	int i,timed;
+	uint64_t start=0,ns=0;
+
+	if (dev->outlen == 0) return(0);
+
+	dev->sent++;
+	PROBE3(dequeue,dev->pi,dev->fd,dev->outlen);
+	timed=(TIMING() || TRACING() || (dev->vcd != NULL) || (dev->rec != NULL) || PROBEON(write) || PROBEON(op));
+	if (timed) start=lcd44780clocknow();
+	i=dev->drv->send(dev,dev->out,dev->outlen);
+	if (timed) ns=lcd44780clocknow()-start;
+	PROBE5(write,dev->pi,dev->fd,dev->outlen,i,ns);
+	if (TRACING()) lcd44780traceadd(dev,TRACESEND,start,ns,dev->outlen,i);
+	if (dev->vcd != NULL) lcd44780vcdframe(dev,start,ns);
+	if (dev->rec != NULL) lcd44780recwrite(dev,start,ns,i);
+	dev->busclock+=ns;
+	COUNT(dev,busns,ns);
+	COUNT(dev,sends,1);
+	COUNT(dev,bytes,dev->outlen);
+	dev->outlen=0;
+
+	if (i < 0) COUNT(dev,failed,1);
+	if (dev->statsfile != NULL) lcd44780statsdue(dev);
+	if ((i < 0) && (dev->err == 0)) dev->err=i;
+	if ((i < 0) && (dev->syncerr == 0)) {
+		dev->syncerr=i;
+		dev->syncerrseq=dev->sent;
+	}
+	return(i);
+}
+
+int lcd44780queue(lcd44780dev *dev, uint8_t *bytes, int len) {
+/******************************************************************************/
+/*                                                                            */
+/* Queue bytes to be sent to the display. They go straight out unless a       */
+/* library function is building up a frame (see lcd44780hold), in which case  */
+/* they are only sent early if the queue fills.                               */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	int i=0;
+
+	if (dev->outlen+len > OUTSIZE) i=lcd44780flush(dev);
+
+	memcpy(dev->out+dev->outlen,bytes,len);
+	dev->outlen+=len;
+
+	if (dev->hold == 0) i=lcd44780flush(dev);
+	return(i);
+}
+
+int lcd44780writebulk(lcd44780dev *dev, uint8_t rs, uint8_t *src, int len) {
+/******************************************************************************/
+/*                                                                            */
+/* Queue a run of bytes for the command (rs=0) or data (rs=1) register,       */
+/* encoded by the backpack driver all in one go rather than a character at a  */
+/* time.                                                                      */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	int i=0,count;
+	uint64_t start=0;
+
+	if (TRACING()) lcd44780tracequeue(dev,rs,src,len);
+	PROBE4(enqueue,dev->pi,dev->fd,rs,len);
+
+	if (TIMING()) start=lcd44780clocknow();
+	dev->drv->encode(dev,rs,src,len);	// Drivers see the address counter before the writes
+	if (TIMING()) COUNT(dev,encodens,lcd44780clocknow()-start);
+
+	for (count=0;count<len;count++) lcd44780track(dev,rs,src[count]);
+
+	if (rs) COUNT(dev,data,len);
+	else {
+		COUNT(dev,commands,len);
+		for (count=0;count<len;count++)
+			if (src[count] & (DDRAMSETADDR|CGRAMSETADDR)) COUNT(dev,addrsent,1);
+	}
+
+	if (dev->hold == 0) i=lcd44780flush(dev);
+	return(i);
+}
+
+void lcd44780queuestrobes(lcd44780dev *dev, uint8_t rs, uint8_t *src, int len) {
+/******************************************************************************/
+/*                                                                            */
+/* Queue the four strobe bytes of each of a run of bytes, encoding them       */
+/* straight into the queue with the bulk encoder. For backpacks that drive    */
+/* the HD44780U in 4 bit mode through one 8 bit port.                         */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	int count,chunk;
+
+	for (count=0;count<len;count+=chunk) {
+		if (dev->outlen+4+dev->pad > OUTSIZE) lcd44780flush(dev);
+
+		if (dev->pad != 0) {			// Fast bus - hold enable low until the byte has been taken
+			chunk=1;
+			memcpy(dev->out+dev->outlen,dev->strobes[rs][src[count]],4);
+			memset(dev->out+dev->outlen+4,dev->strobes[rs][src[count]][3],dev->pad);
+			dev->outlen+=4+dev->pad;
+			continue;
+		}
+
+		chunk=(OUTSIZE-dev->outlen)/4;
+		if (chunk > len-count) chunk=len-count;
+
+		lcd44780encodebytes(dev,rs,src+count,chunk,dev->out+dev->outlen);
+		dev->outlen+=4*chunk;
+	}
+	return;
+}
+
+uint8_t lcd44780buspad(uint32_t hz) {
+/******************************************************************************/
+/*                                                                            */
+/* Idle bytes to send after each byte's strobes on an I2C bus clocked at hz,  */
+/* so the HD44780U has finished with it (EXECNS) before enable rises again.   */
+/* None are needed at 100kHz, where a single byte on the bus takes 90us.      */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	uint64_t bytens;
+
+	if (hz == 0) return (0);
+	bytens=I2CBYTECLOCKS*1000000000ULL/hz;
+	return ((EXECNS+bytens-1)/bytens-1);
+}
+
+/* PCF8574 backpack driver */
+
+void lcd44780pcfnibble(lcd44780dev *dev, uint8_t data) {
+/******************************************************************************/
+/*                                                                            */
+/* Queue the low 4 bits of data on D4-D7, enable high then low.               */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	uint8_t strobe[2];
+
+	strobe[0]=dev->nibble[data&0x0F]|dev->bl|dev->enbit;
+	strobe[1]=strobe[0]&(~dev->enbit);
+
+	lcd44780queue(dev,strobe,2);
+	return;
+}
+
+void lcd44780pcflight(lcd44780dev *dev) {
+/******************************************************************************/
+/*                                                                            */
+/* Queue the backlight bit on its own - the HD44780U ignores it.              */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	lcd44780queue(dev,(uint8_t *)&dev->bl,1);
+	return;
+}
+
+static int lcd44780pcfsend(lcd44780dev *dev, uint8_t *buf, int len) {
+/******************************************************************************/
+/*                                                                            */
+/* Everything goes to the PCF8574 as a single I2C write.                      */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	return(i2c_write_device(dev->pi,dev->fd,(char *)buf,len));
+}
+
+const lcd44780driver lcd44780pcf8574drv={0, NULL, lcd44780queuestrobes, lcd44780pcfnibble, lcd44780pcflight, lcd44780pcfsend, NULL, NULL, 0};
+
+
+void lcd44780hold(lcd44780dev *dev) {
+/******************************************************************************/
+/*                                                                            */
+/* Start (or nest) a frame - bytes are queued until the matching              */
+/* lcd44780release, then sent together.                                       */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	if (dev->hold++ == 0) dev->err=0;
+	return;
+}
+
+int lcd44780release(lcd44780dev *dev) {
+/******************************************************************************/
+/*                                                                            */
+/* End a frame started by lcd44780hold. The outermost release sends the       */
+/* frame, returning the first error from any write in it, or 0.               */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	if (--dev->hold > 0) return(0);
+
+	lcd44780flush(dev);
+	return(dev->err);
+}
+
+void lcd44780delay(lcd44780dev *dev, long ns) {
+/******************************************************************************/
+/*                                                                            */
+/* Send anything queued, then wait for ns nanoseconds - so the wait starts    */
+/* once the slow instruction has actually reached the display (for drivers    */
+/* that don't wait for each write to finish, once they say it has). Drivers   */
+/* that keep to the HD44780U's timings themselves aren't waited for.          */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	uint64_t start,slept;
+
+	lcd44780flush(dev);
+	if (dev->drv->sync != NULL) dev->drv->sync(dev);
+	if (dev->drv->selftimed) return;		// e.g. the kernel driver
+
+	if ((TIMING() == 0) && (TRACING() == 0) && (PROBEON(sleep) == 0)) {
+		lcd44780clocksleep(ns);
+		return;
+	}
+
+	start=lcd44780clocknow();
+	lcd44780clocksleep(ns);
+	slept=lcd44780clocknow()-start;
+	PROBE3(sleep,dev->pi,dev->fd,slept);
+	if (TRACING()) lcd44780traceadd(dev,TRACESLEEP,start,slept,0,0);
+	COUNT(dev,sleepns,slept);
+	return;
+}
+
+int lcd44780nextaddr(lcd44780dev *dev, int ac) {
+/******************************************************************************/
+/*                                                                            */
+/* Work out where the HD44780U address counter moves to after a read or       */
+/* write. In 2 line mode DDRAM runs 0x00-0x27 then 0x40-0x67 and wraps        */
+/* around; CGRAM runs 0x00-0x3F.                                              */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	if (ac == ACUNKNOWN) return(ACUNKNOWN);
+
+	if (ac & CGRAMAC) {
+		ac=(dev->inc) ? ac+1 : ac-1;
+		return(CGRAMAC|(ac&0x3F));
+	}
+
+	if (dev->inc) {
+		if (ac == 0x27) return(0x40);
+		if (ac == 0x67) return(0x00);
+		return(ac+1);
+	}
+
+	if (ac == 0x40) return(0x27);
+	if (ac == 0x00) return(0x67);
+	return(ac-1);
+}
+
+static void lcd44780track(lcd44780dev *dev, uint8_t rs, uint8_t data) {
+/******************************************************************************/
+/*                                                                            */
+/* Follow the effect of a command (rs=0) or data write (rs=1) on the          */
+/* HD44780U, so the shadow copies of DDRAM and CGRAM and the address counter  */
+/* always match what the controller holds.                                    */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	if (rs) {
+		if (dev->ac == ACUNKNOWN) return;
+		if (dev->ac & CGRAMAC) {
+			dev->cgram[(dev->ac>>3)&0x07][dev->ac&0x07]=data&0x1F;
+			dev->cgvalid|=1<<((dev->ac>>3)&0x07);
+		}
+		else {
+			dev->ddram[dev->ac]=data;
+			dev->fb[dev->ac]=data;
+		}
+		dev->ac=lcd44780nextaddr(dev,dev->ac);
+	}
+	else if (data & DDRAMSETADDR) {
+		dev->ac=data&0x7F;
+	}
+	else if (data & CGRAMSETADDR) {
+		dev->ac=CGRAMAC|(data&0x3F);
+	}
+	else if (data & FUNCTIONSET) {
+		return;						// Address counter unaffected
+	}
+	else if (data & CURSORMOVE) {
+		if ((data & GODISPLAY) == 0) dev->ac=ACUNKNOWN;	// Cursor shifted
+	}
+	else if (data & DISPLAYCONTROL) {
+		return;						// Address counter unaffected
+	}
+	else if (data & ENTRYMODESET) {
+		dev->inc=(data & ENTRYLEFT) ? 1 : 0;			// I/D bit
+	}
+	else if (data & CURSORHOME) {
+		dev->ac=0x00;
+	}
+	else if (data & CLEARDISPLAY) {
+		memset(dev->ddram,' ',DDRAMSIZE);
+		memset(dev->fb,' ',DDRAMSIZE);
+		dev->ac=0x00;
+		dev->inc=1;					// Clear also sets I/D to increment
+	}
+	return;
+}
+
+char lcd44780glyphmap(lcd44780dev *dev, char c) {
+/******************************************************************************/
+/*                                                                            */
+/* With glyph banks enabled, character codes 0x00-0x0F name one of the        */
+/* BANKGLYPHS logical glyphs. Translate them to the CGRAM slot currently      */
+/* showing that glyph. Any other character is returned unchanged.             */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	uint8_t glyph;
+
+	if ((dev->banks == 0) || ((uint8_t)c >= 0x10)) return(c);
+
+	glyph=(uint8_t)c%BANKGLYPHS;
+	return(glyph+(((dev->bank>>glyph)&1)*BANKGLYPHS));
+}
+
+static int lcd44780flipped(lcd44780dev *dev, uint8_t code) {
+/******************************************************************************/
+/*                                                                            */
+/* Whether character code is the slot currently showing a glyph staged since  */
+/* the last flip, and so is to move to the glyph's other slot.                */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	uint8_t glyph;
+
+	if (code >= 0x10) return(0);
+
+	glyph=code%BANKGLYPHS;
+	if ((dev->staged & (1<<glyph)) == 0) return(0);
+	return((code&0x07) == (uint8_t)lcd44780glyphmap(dev,glyph));
+}
+
+uint8_t lcd44780ddaddr(int row, int col) {
+/******************************************************************************/
+/*                                                                            */
+/* DDRAM address of a cell, with row and col counted from 0.                  */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	return(rowstart[row]+col);
+}
+
+int lcd44780checkpos(lcd44780dev *dev, uint8_t row, uint8_t col) {
+/******************************************************************************/
+/*                                                                            */
+/* Check row is in the range ORIGIN to ORIGIN+rows-1 and col is in the range  */
+/* ORIGIN to ORIGIN+cols-1, reporting any error to stderr.                    */
+/*                                                                            */
+/* Returns 0 if the position is on the display, or the error code.            */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	int i=0;
+
+        if (row < ORIGIN) i=ROWTOOLOW;
+	else if (row > ORIGIN+dev->rows-1) i=ROWTOOHIGH;
+        else if (col < ORIGIN) i=COLTOOLOW;
+	else if (col > ORIGIN+dev->cols-1) i=COLTOOHIGH;
+
+	if (i != 0) lcd44780error_fprintf(i);
+	return(i);
+}
+
+int lcd44780freeslot(lcd44780dev *dev) {
+/******************************************************************************/
+/*                                                                            */
+/* Choose a CGRAM slot nobody is using. One neither showing on the display    */
+/* nor in the framebuffer waiting for lcd44780commit is preferred, then one   */
+/* that has never been written.                                               */
+/*                                                                            */
+/* Returns NOGLYPHSLOT if every slot is in use.                               */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	int slot,row,col,best=NOGLYPHSLOT,bestscore=-1,score;
+	uint8_t code,pending;
+
+	for (slot=0;slot<CGRAMSLOTS;slot++) {
+		if (dev->cgref[slot] != 0) continue;
+		score=((dev->cgvalid & (1<<slot)) == 0) ? 1 : 0;
+		for (row=0;row<dev->rows;row++) {
+			for (col=0;col<dev->cols;col++) {
+				code=dev->ddram[rowstart[row]+col];
+				pending=dev->fb[rowstart[row]+col];
+				if ((code < 0x10) && ((code&0x07) == slot)) score=-2;
+				if ((pending < 0x10) && ((pending&0x07) == slot)) score=-2;
+			}
+		}
+		score+=2;
+		if (score > bestscore) {
+			best=slot;
+			bestscore=score;
+		}
+	}
+
+	return(best);
+}
+
+int lcd44780loadglyph(lcd44780dev *dev, uint8_t *bitmap) {
+/******************************************************************************/
+/*                                                                            */
+/* Glyph cache. Return the CGRAM slot holding bitmap, uploading it first if   */
+/* no slot already has it, and count the caller as a user of the slot.        */
+/* Slots owned by lcd44780defchar, the glyph banks or the pixel canvas are    */
+/* never shared or reused.                                                    */
+/*                                                                            */
+/* Returns NOGLYPHSLOT if every slot is in use.                               */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	int i,slot,row;
+	uint8_t glyph[8];
+
+	for (row=0;row<8;row++) glyph[row]=bitmap[row]&0x1F;
+
+	for (slot=0;slot<CGRAMSLOTS;slot++) {
+		if ((dev->cgref[slot] == GLYPHPINNED) || ((dev->cgvalid & (1<<slot)) == 0)) continue;
+		if (memcmp(dev->cgram[slot],glyph,8) == 0) {
+			dev->cgref[slot]++;
+			return(slot);
+		}
+	}
+
+	slot=lcd44780freeslot(dev);
+	if (slot < 0) return(slot);
+
+	i=lcd44780defchar(dev->pi,dev->fd,slot,glyph);
+	if (i < 0) return(i);
+
+	dev->cgref[slot]=1;
+	return(slot);
+}
+
+int lcd44780commitdev(lcd44780dev *dev) {
+/******************************************************************************/
+/*                                                                            */
+/* Send every visible character that differs between the framebuffer and the  */
+/* shadow DDRAM copy, in address order. A set address command is only sent    */
+/* when the address counter isn't already pointing at the next changed cell.  */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	int i=0,row,col;
+	uint8_t addr;
+
+	lcd44780hold(dev);
+	for (row=0;row<dev->rows;row++) {
+		for (col=0;col<dev->cols;col++) {
+			addr=rowstart[row]+col;
+			if (dev->fb[addr] == dev->ddram[addr]) continue;
+			if (dev->ac != addr) {
+				i=lcd44780writecmd4(dev->pi,dev->fd,DDRAMSETADDR|addr);
+			}
+			else COUNT(dev,addrskipped,1);
+			i=lcd44780writedata(dev->pi,dev->fd,dev->fb[addr]);
+		}
+	}
+	i=lcd44780release(dev);
+
+	return(i);
+}
+
 int lcd44780setpos(int pi, int fd, int row, int col) {
 /******************************************************************************/
 /*                                                                            */
@@ -122,13 +758,20 @@ void lcd44780error_fprintf(int errnum) {
 /* (c) Tim Holyoake, 10th May 2020.                                           */
 /*                                                                            */
 /******************************************************************************/
-        char errcode[5][80]={"Row number too low (less than ORIGIN) specified",
+        char errcode[12][80]={"Row number too low (less than ORIGIN) specified",
                              "Row number too high (greater than ORIGIN+lcdrows) specified",
                              "Column number out of range",
         	             "Column number too low (less than ORIGIN) specified",
-                             "Column number too high (greater than ORIGIN+lcdcols) specified"};
-
-        if ((errnum > ROWTOOLOW) || (errnum < COLTOOHIGH)) {
+                             "Column number too high (greater than ORIGIN+lcdcols) specified",
+                             "Unable to allocate memory for the display state",
+                             "CGRAM slot or glyph number out of range",
+                             "Glyph banks are not enabled",
+                             "No free CGRAM slot for a user defined character",
+                             "Widget type, size or range not valid",
+                             "Setting not one of the values allowed",
+                             "Unable to open or set up the display's device"};
+
+        if ((errnum > ROWTOOLOW) || (errnum < LASTERROR)) {
 		fprintf(stderr,"Unknown LCD HD44780U error number(%d)\n",errnum);
         }
         else {
@@ -144,11 +787,24 @@ int lcd44780str(int pi, int fd, char *writebuf, uint8_t row, uint8_t col) {
 /* specified row of the display. Row ORIGIN = top row; Row ORIGIN+lcdrows-1   */
 /* bottom row.                                                                */
 /*                                                                            */
+/* The string is UTF-8, translated for the display's character ROM (see       */
+/* lcd44780setrom), and truncated after as many characters as there are       */
+/* columns left on the row.                                                   */
+/*                                                                            */
 /* (c) Tim Holyoake, 10th May 2020.                                           */
 /*                                                                            */
 /******************************************************************************/
-	int i,count,len;
-        char buf[lcdcols];
+	int i,len,args[2];
+	lcd44780dev *dev;
+	lcd44780latmark mark;
+
+	dev=lcd44780getdev(pi,fd,1);
+	if (dev == NULL) {
+		lcd44780error_fprintf(NOMEMORY);
+		return (NOMEMORY);
+	}
+
+        uint8_t buf[dev->cols];
 
      	/* Error handling - check row specified is in the range ORIGIN to ORIGIN+lcdrows-1 */
 	/* and that column is in the range ORIGIN to ORIGIN+lcdcols-1 */
@@ -157,7 +813,7 @@ int lcd44780str(int pi, int fd, char *writebuf, uint8_t row, uint8_t col) {
 		lcd44780error_fprintf(ROWTOOLOW);
 		return (ROWTOOLOW);
 	} 
-	else if (row > ORIGIN+lcdrows-1) {
+	else if (row > ORIGIN+dev->rows-1) {
 		lcd44780error_fprintf(ROWTOOHIGH);
 		return (ROWTOOHIGH);
 	}
@@ -166,23 +822,27 @@ int lcd44780str(int pi, int fd, char *writebuf, uint8_t row, uint8_t col) {
 		lcd44780error_fprintf(COLTOOLOW);
 		return (COLTOOLOW);
 	} 
-	else if (col > ORIGIN+lcdcols-1) {
+	else if (col > ORIGIN+dev->cols-1) {
 		lcd44780error_fprintf(COLTOOHIGH);
 		return (COLTOOHIGH);
 	}
 
         /* Buffer is truncated to the row length if it is longer than the space left on the row */
 
-	len=strlen(writebuf);
-	if (len > lcdcols-col+ORIGIN) len=lcdcols-col+ORIGIN;
-        strncpy(buf,writebuf,len);
+	args[0]=row;
+	args[1]=col;
+	lcd44780reccall(dev,RECSTR,2,args,writebuf,RECSTRING);
+	lcd44780latstart(dev,&mark);
+	len=lcd44780utf8cells(dev,writebuf,UTF8TERMINATED,buf,dev->cols-col+ORIGIN);
 
-	/* Set the display to the correct row and column */
+	/* Set the display to the correct row and column, then send it all as one frame */
+	lcd44780hold(dev);
 	i=lcd44780setpos(pi,fd,row-ORIGIN,col-ORIGIN);
 
-	for (count=0;count<len;count++) { 
-		i=lcd44780writedata(pi,fd,buf[count]);
-	}
+	i=lcd44780writebulk(dev,1,buf,len);
+	i=lcd44780release(dev);
+	lcd44780latend(dev,LCD44780OPSTR,&mark);
+	lcd44780recend(dev,i);
 
         return(i);
 }
@@ -196,8 +856,16 @@ int lcd44780clearline(int pi, int fd, uint8_t row, uint8_t col) {
 /* (c) Tim Holyoake, 10th May 2020.                                           */
 /*                                                                            */
 /******************************************************************************/
-	int i,count;
+	int i,count,args[2];
         char buf[1]={" "};
+	lcd44780dev *dev;
+	lcd44780latmark mark;
+
+	dev=lcd44780getdev(pi,fd,1);
+	if (dev == NULL) {
+		lcd44780error_fprintf(NOMEMORY);
+		return (NOMEMORY);
+	}
 
      	/* Error handling - check row specified is in the range ORIGIN to ORIGIN+lcdrows-1 */
 	/* and that column is in the range ORIGIN to ORIGIN+lcdcols-1 */
@@ -206,7 +874,7 @@ int lcd44780clearline(int pi, int fd, uint8_t row, uint8_t col) {
 		lcd44780error_fprintf(ROWTOOLOW);
 		return (ROWTOOLOW);
 	} 
-	else if (row > ORIGIN+lcdrows-1) {
+	else if (row > ORIGIN+dev->rows-1) {
 		lcd44780error_fprintf(ROWTOOHIGH);
 		return (ROWTOOHIGH);
 	}
@@ -215,17 +883,25 @@ int lcd44780clearline(int pi, int fd, uint8_t row, uint8_t col) {
 		lcd44780error_fprintf(COLTOOLOW);
 		return (COLTOOLOW);
 	} 
-	else if (col > ORIGIN+lcdcols-1) {
+	else if (col > ORIGIN+dev->cols-1) {
 		lcd44780error_fprintf(COLTOOHIGH);
 		return (COLTOOHIGH);
 	}
 
-	/* Set the display to the correct row and column */
+	/* Set the display to the correct row and column, then send it all as one frame */
+	args[0]=row;
+	args[1]=col;
+	lcd44780reccall(dev,RECCLEARLINE,2,args,NULL,0);
+	lcd44780latstart(dev,&mark);
+	lcd44780hold(dev);
 	i=lcd44780setpos(pi,fd,row-ORIGIN,col-ORIGIN);
 
-	for (count=col-ORIGIN;count<lcdcols;count++) { 
+	for (count=col-ORIGIN;count<dev->cols;count++) { 
 		i=lcd44780writedata(pi,fd,buf[0]);
 	}
+	i=lcd44780release(dev);
+	lcd44780latend(dev,LCD44780OPCLEARLINE,&mark);
+	lcd44780recend(dev,i);
 
         return(i);
 }
@@ -240,8 +916,16 @@ int lcd44780chr(int pi, int fd, char *writebuf, uint8_t row, uint8_t col) {
 /* (c) Tim Holyoake, 20th May 2020.                                           */
 /*                                                                            */
 /******************************************************************************/
-	int i;
-        char buf[1];
+	int i,len,args[2];
+        uint8_t buf[1];
+	lcd44780dev *dev;
+	lcd44780latmark mark;
+
+	dev=lcd44780getdev(pi,fd,1);
+	if (dev == NULL) {
+		lcd44780error_fprintf(NOMEMORY);
+		return (NOMEMORY);
+	}
 
      	/* Error handling - check row & column specified is in the range ORIGIN to ORIGIN+lcdrows-1 */
 
@@ -249,7 +933,7 @@ int lcd44780chr(int pi, int fd, char *writebuf, uint8_t row, uint8_t col) {
 		lcd44780error_fprintf(ROWTOOLOW);
 		return (ROWTOOLOW);
 	} 
-	else if (row > ORIGIN+lcdrows-1) {
+	else if (row > ORIGIN+dev->rows-1) {
 		lcd44780error_fprintf(ROWTOOHIGH);
 		return (ROWTOOHIGH);
 	}
@@ -258,20 +942,30 @@ int lcd44780chr(int pi, int fd, char *writebuf, uint8_t row, uint8_t col) {
 		lcd44780error_fprintf(COLTOOLOW);
 		return (COLTOOLOW);
 	} 
-	else if (col > ORIGIN+lcdcols-1) {
+	else if (col > ORIGIN+dev->cols-1) {
 		lcd44780error_fprintf(COLTOOHIGH);
 		return (COLTOOHIGH);
 	}
 
-        /* Buffer is truncated to 1 character */
+        /* Buffer is truncated to 1 (UTF-8) character - '\0' is CGRAM slot 0, as it always was */
 
-        strncpy(buf,writebuf,1);
+	len=lcd44780utf8len(dev,writebuf);
+	args[0]=row;
+	args[1]=col;
+	lcd44780reccall(dev,RECCHR,2,args,writebuf,(len == 0) ? 1 : len);
+	lcd44780latstart(dev,&mark);
+	if (len == 0) buf[0]=lcd44780glyphmap(dev,0);
+	else lcd44780utf8cells(dev,writebuf,len,buf,1);
 
 	/* Set the display to the correct row and column */
+	lcd44780hold(dev);
 	i=lcd44780setpos(pi,fd,row-ORIGIN,col-ORIGIN);
 
 	/* Output the character */
 	i=lcd44780writedata(pi,fd,buf[0]);
+	i=lcd44780release(dev);
+	lcd44780latend(dev,LCD44780OPCHR,&mark);
+	lcd44780recend(dev,i);
 
         return(i);
 }
@@ -294,38 +988,67 @@ int lcd44780init(int pi, int fd, int rows, int cols) {
 /* The reasons for this are described in various tutorials and datasheets     */
 /* that can be found with ease on t'internet.                                 */
 /*                                                                            */
+/* Backpacks with all 8 data lines wired (see lcd44780setbackpack) skip the   */
+/* switch to 4 bit mode.                                                      */
+/*                                                                            */
 /* (c) Tim Holyoake, 10th May 2020.                                           */
 /*                                                                            */
 /******************************************************************************/
-        int i,count;
+        int i,count,args[2];
 	char buf;
-	struct timespec t;
+	lcd44780dev *dev;
+	lcd44780latmark mark;
+
+	dev=lcd44780getdev(pi,fd,1);
+	if (dev == NULL) {
+		lcd44780error_fprintf(NOMEMORY);
+		return (NOMEMORY);
+	}
+
+	args[0]=rows;
+	args[1]=cols;
+	lcd44780reccall(dev,RECINIT,2,args,NULL,0);
+	lcd44780latstart(dev,&mark);
+	if (dev->drv->begin != NULL) {		// Get the backpack ready
+		i=dev->drv->begin(dev);
+		if (i < 0) {
+			lcd44780recend(dev,i);
+			return(i);
+		}
+	}
 
-	lcdrows=rows;			// Save the display layout
-	lcdcols=cols;
+	dev->rows=rows;			// Save the display layout
+	dev->cols=cols;
+	dev->banks=0;			// CGRAM starts as 8 independent slots
+	dev->bank=0;
+	dev->staged=0;
 	
-	t.tv_sec=0;			// Time to sleep = 0 seconds plus a
-	t.tv_nsec=200000000L;		// minimum of 200ms (200,000,000 nanoseconds)
+	// Each delay is a minimum of 200ms (200,000,000 nanoseconds)
 
- 	
-	nanosleep(&t, (struct timespec *)NULL);			// Wait for power up
+	lcd44780delay(dev,200000000L);				// Wait for power up
 
 	buf=((FUNCTIONSET|EIGHTBIT)>>4)&0x0F;		        // Weird initialization sequence to
 	for (count=1; count<=3; count++) {			// put the HD44780U into a known state
 	 	i=lcd44780writecmd8(pi,fd,buf);			// (8 bit mode) before setting it into 4 bit mode.
-		nanosleep(&t, (struct timespec *)NULL);		// Slow, so extra delay needed
+		lcd44780delay(dev,200000000L);			// Slow, so extra delay needed
 	}
 
-	buf=((FUNCTIONSET|FOURBIT)>>4)&0x0F;			// Set display to use 4 bit cmnds
+	if (dev->drv->eightbit) {				// Backpack has all 8 data lines, so
+		buf=FUNCTIONSET|EIGHTBIT|TWOLINE;		// stay in 8 bit mode, using 2 lines
+		i=lcd44780writecmd4(pi,fd,buf);
+	}
+	else {
+		buf=((FUNCTIONSET|FOURBIT)>>4)&0x0F;		// Set display to use 4 bit cmnds
 								// Absolutely required if I2C is used!
-	i=lcd44780writecmd8(pi,fd,buf);
-	nanosleep(&t, (struct timespec *)NULL);			// Slow, so extra delay needed
+		i=lcd44780writecmd8(pi,fd,buf);
+		lcd44780delay(dev,200000000L);			// Slow, so extra delay needed
 
-	/* We're now definitely in 4 bit mode, so no longer need to shift the command down into the
-           bottom 4 bits (before it's shifted up 4 and combined with the backlight and enable bits) */
+		/* We're now definitely in 4 bit mode, so no longer need to shift the command down into the
+		   bottom 4 bits (before it's shifted up 4 and combined with the backlight and enable bits) */
 
-	buf=FUNCTIONSET|FOURBIT|TWOLINE;			// Set display to use 2 lines
-	i=lcd44780writecmd4(pi,fd,buf);
+		buf=FUNCTIONSET|FOURBIT|TWOLINE;		// Set display to use 2 lines
+		i=lcd44780writecmd4(pi,fd,buf);
+	}
 
 	lcd44780setdisplay(pi,fd,DISPLAYOFF,BLINKOFF,CURSOROFF);// Turn the display back on
 
@@ -336,6 +1059,8 @@ int lcd44780init(int pi, int fd, int rows, int cols) {
 
 	lcd44780setdisplay(pi,fd,DISPLAYON,BLINKOFF,CURSOROFF);	// Turn the display back on
 	                               			 	// cursor and blink off
+	lcd44780latend(dev,LCD44780OPINIT,&mark);
+	lcd44780recend(dev,i);
 	return(i);
 }
 
@@ -352,13 +1077,20 @@ int lcd44780clear(int pi, int fd)
 {
 	int i;	
 	char buf=CLEARDISPLAY;
-	struct timespec t;
+	lcd44780dev *dev;
+	lcd44780latmark mark;
 
-	t.tv_sec=0;			// Time to sleep = 0 seconds plus a
-	t.tv_nsec=100000000L;		// minimum of 100ms (100,000,000 nanoseconds)
+	dev=lcd44780getdev(pi,fd,1);
+	if (dev == NULL) return(NOMEMORY);
 
+	// Time to sleep = 0 seconds plus a minimum of 100ms (100,000,000 nanoseconds)
+
+	lcd44780reccall(dev,RECCLEAR,0,NULL,NULL,0);
+	lcd44780latstart(dev,&mark);
 	i=lcd44780writecmd4(pi,fd,buf);		// Clearing the display is slow
-	nanosleep(&t, (struct timespec *)NULL);	// so a delay is required.
+	lcd44780delay(dev,100000000L);		// so a delay is required.
+	lcd44780latend(dev,LCD44780OPCLEAR,&mark);
+	lcd44780recend(dev,i);
 
 	return(i);
 }
@@ -376,13 +1108,17 @@ int lcd44780home(int pi, int fd)
 {
 	int i;	
 	char buf=CURSORHOME;
-	struct timespec t;
+	lcd44780dev *dev;
+
+	dev=lcd44780getdev(pi,fd,1);
+	if (dev == NULL) return(NOMEMORY);
 
-	t.tv_sec=0;			// Time to sleep = 0 seconds plus a
-	t.tv_nsec=100000000L;		// minimum of 100ms (100,000,000 nanoseconds)
+	// Time to sleep = 0 seconds plus a minimum of 100ms (100,000,000 nanoseconds)
 
+	lcd44780reccall(dev,RECHOME,0,NULL,NULL,0);
 	i=lcd44780writecmd4(pi,fd,buf);		// Can be slow, so
-	nanosleep(&t, (struct timespec *)NULL);	// a delay is required.
+	lcd44780delay(dev,100000000L);		// a delay is required.
+	lcd44780recend(dev,i);
 
 	return(i);
 }
@@ -402,14 +1138,23 @@ int lcd44780writecmd8(int pi, int fd, char data)
 /*                                                                            */
 /******************************************************************************/
 {
-	int i;
-
-	data=((data<<4)&0xF0)|bl44780|ENABLE;
-	i=i2c_write_device(pi,fd,&data,1);
-	data=data&(~ENABLE);
-	i=i2c_write_device(pi,fd,&data,1);
-
-	return (i);
+	int i=0,args[1];
+	lcd44780dev *dev;
+
+	dev=lcd44780getdev(pi,fd,1);
+	if (dev == NULL) return(NOMEMORY);
+	dev->ac=ACUNKNOWN;			// Mode is being (re)established
+
+	args[0]=(uint8_t)data;
+	lcd44780reccall(dev,RECWRITECMD8,1,args,NULL,0);
+	if (TRACING()) lcd44780tracequeue(dev,0,(uint8_t *)&data,1);
+	PROBE4(enqueue,pi,fd,0,1);
+	dev->drv->nibble(dev,data);
+	COUNT(dev,commands,1);
+
+	if (dev->hold == 0) i=lcd44780flush(dev);
+	lcd44780recend(dev,i);
+	return(i);
 }
 
 int lcd44780writecmd4(int pi, int fd, char data)
@@ -428,26 +1173,23 @@ int lcd44780writecmd4(int pi, int fd, char data)
 /*                                                                            */
 /*       The data is sent twice for each nibble - enable high, then low.      */
 /*                                                                            */
+/*       The four bytes come ready made from the display's strobe table (see  */
+/*       lcd44780buildstrobes).                                               */
+/*                                                                            */
 /* (c) Tim Holyoake, 17th May 2020.                                           */
 /*                                                                            */
 /******************************************************************************/
 {
-	int i;
-	char high, low;
-
-	high=data&0xF0;
-	low=(data<<4)&0xF0;
+	int i,args[1];
+	lcd44780dev *dev;
 
-	high=high|bl44780|ENABLE;
-	i=i2c_write_device(pi,fd,&high,1);
-	high=high&(~ENABLE);
-	i=i2c_write_device(pi,fd,&high,1);
-	
-	low=low|bl44780|ENABLE;
-	i=i2c_write_device(pi,fd,&low,1);
-	low=low&(~ENABLE);
-	i=i2c_write_device(pi,fd,&low,1);
+	dev=lcd44780getdev(pi,fd,1);
+	if (dev == NULL) return(NOMEMORY);
 
+	args[0]=(uint8_t)data;
+	lcd44780reccall(dev,RECWRITECMD4,1,args,NULL,0);
+	i=lcd44780writebulk(dev,0,(uint8_t *)&data,1);
+	lcd44780recend(dev,i);
 	return (i);
 }
 
@@ -465,22 +1207,16 @@ int lcd44780writedata(int pi, int fd, char data)
 /*                                                                            */
 /******************************************************************************/
 {
-	int i;
-	char high, low;
+	int i,args[1];
+	lcd44780dev *dev;
 
-	high=data&0xF0;
-	low=(data<<4)&0xF0;
-
-	high=high|bl44780|REGISTERSET|ENABLE;
-	i=i2c_write_device(pi,fd,&high,1);
-	high=high&(~ENABLE);
-	i=i2c_write_device(pi,fd,&high,1);
-	
-	low=low|bl44780|REGISTERSET|ENABLE;
-	i=i2c_write_device(pi,fd,&low,1);
-	low=low&(~ENABLE);
-	i=i2c_write_device(pi,fd,&low,1);
+	dev=lcd44780getdev(pi,fd,1);
+	if (dev == NULL) return(NOMEMORY);
 
+	args[0]=(uint8_t)data;
+	lcd44780reccall(dev,RECWRITEDATA,1,args,NULL,0);
+	i=lcd44780writebulk(dev,1,(uint8_t *)&data,1);
+	lcd44780recend(dev,i);
 	return (i);
 }
 
@@ -489,20 +1225,39 @@ int lcd44780backlight(int pi, int fd, uint8_t setting)
 /*                                                                            */
 /* Change the backlight setting (0=OFF, any other value = ON)                 */
 /*                                                                            */
-/* This data (0x00 for OFF, 0x08 for on) is written directly to the I2C bus   */
-/* as the command is not used by the HD44708U - just the PCF8574 backpack.    */
+/* This data (0x00 for OFF, 0x08 for on as usually wired) is written directly */
+/* to the I2C bus as the command is not used by the HD44708U - just the       */
+/* PCF8574 backpack.                                                          */
+/* The backlight bit is part of every byte sent, so the display's strobe      */
+/* table is rebuilt.                                                          */
 /*                                                                            */
 /* (c) Tim Holyoake, 17th May 2020.                                           */
 /*                                                                            */
 /******************************************************************************/
 {
-	int i;
+	int i=0,args[1];
+	uint8_t bl;
+	lcd44780dev *dev;
+
+	dev=lcd44780getdev(pi,fd,1);
+	if (dev == NULL) return(NOMEMORY);
 
-	if (setting == 0) bl44780=0x00;
-	else bl44780=BACKLIGHT;
+	args[0]=setting;
+	lcd44780reccall(dev,RECBACKLIGHT,1,args,NULL,0);
 
-	i=i2c_write_device(pi,fd,&bl44780,1);
+	dev->blon=(setting == 0) ? 0 : 1;
+	if ((dev->blon && (dev->rgb & RGBBLUE))^dev->pins.blinvert) bl=dev->blbit;
+	else bl=0x00;
 
+	if (bl != dev->bl) {
+		dev->bl=bl;
+		lcd44780buildstrobes(dev);
+	}
+
+	dev->drv->light(dev);
+
+	if (dev->hold == 0) i=lcd44780flush(dev);
+	lcd44780recend(dev,i);
 	return(i);
 }
 
@@ -518,8 +1273,17 @@ int lcd44780setdisplay(int pi, int fd, uint8_t mode, uint8_t blink, uint8_t curs
 /*                                                                            */
 /******************************************************************************/
 {
-	int i;
+	int i,args[3];
 	char cmd=DISPLAYCONTROL;
+	lcd44780dev *dev;
+
+	dev=lcd44780getdev(pi,fd,1);
+	if (dev == NULL) return(NOMEMORY);
+
+	args[0]=mode;
+	args[1]=blink;
+	args[2]=cursor;
+	lcd44780reccall(dev,RECSETDISPLAY,3,args,NULL,0);
 
 	cmd = (mode == 0) ? cmd|DISPLAYOFF : cmd|DISPLAYON;
 
@@ -528,6 +1292,484 @@ int lcd44780setdisplay(int pi, int fd, uint8_t mode, uint8_t blink, uint8_t curs
 	cmd = (cursor == 0) ? cmd|CURSOROFF : cmd|CURSORON;
 
 	i=lcd44780writecmd4(pi,fd,cmd);
+	lcd44780recend(dev,i);
+
+	return (i);
+}
+
+int lcd44780draw(int pi, int fd, char *writebuf, uint8_t row, uint8_t col)
+/******************************************************************************/
+/*                                                                            */
+/* Place a UTF-8 string in the framebuffer at position col of the specified   */
+/* row, truncated at the end of the row like lcd44780str. Nothing is sent to  */
+/* the display until lcd44780commit is called, which then only sends the      */
+/* characters that differ from what the display already shows.                */
+/*                                                                            */
+/* Prerequisite - lcd44780init must have been successfully called first.      */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+{
+	int i,args[2];
+	lcd44780dev *dev;
+
+	dev=lcd44780getdev(pi,fd,1);
+	if (dev == NULL) {
+		lcd44780error_fprintf(NOMEMORY);
+		return (NOMEMORY);
+	}
+
+	i=lcd44780checkpos(dev,row,col);
+	if (i != 0) return (i);
+
+	args[0]=row;
+	args[1]=col;
+	lcd44780reccall(dev,RECDRAW,2,args,writebuf,RECSTRING);
+	lcd44780utf8cells(dev,writebuf,UTF8TERMINATED,&dev->fb[rowstart[row-ORIGIN]+col-ORIGIN],dev->cols-col+ORIGIN);
+	if ((TIMING() || PROBEON(commit)) && (dev->drawnat == 0)) dev->drawnat=lcd44780clocknow();	// Start of the commit's latency
+	lcd44780recend(dev,0);
+
+	return (0);
+}
+
+int lcd44780commit(int pi, int fd)
+/******************************************************************************/
+/*                                                                            */
+/* Bring the display up to date with the framebuffer. Only changed characters */
+/* are sent, and a set address command only when the next changed character   */
+/* doesn't follow on from the last one written.                               */
+/*                                                                            */
+/* Prerequisite - lcd44780init must have been successfully called first.      */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+{
+	int i,probed;
+	uint64_t start=0;
+	lcd44780dev *dev;
+	lcd44780latmark mark;
+
+	dev=lcd44780getdev(pi,fd,1);
+	if (dev == NULL) {
+		lcd44780error_fprintf(NOMEMORY);
+		return (NOMEMORY);
+	}
+
+	lcd44780reccall(dev,RECCOMMIT,0,NULL,NULL,0);
+	lcd44780latstart(dev,&mark);
+	if (dev->drawnat != 0) mark.start=dev->drawnat;	// Timed from the first draw
+	probed=PROBEON(commit);
+	if (probed) start=(dev->drawnat != 0) ? dev->drawnat : lcd44780clocknow();
+	dev->drawnat=0;
+
+	i=lcd44780commitdev(dev);
+	lcd44780latend(dev,LCD44780OPCOMMIT,&mark);
+	lcd44780recend(dev,i);
+	if (probed) {
+		PROBE4(commit,pi,fd,i,lcd44780clocknow()-start);
+	}
+	return (i);
+}
+
+int lcd44780defchar(int pi, int fd, uint8_t slot, uint8_t *bitmap)
+/******************************************************************************/
+/*                                                                            */
+/* Define user character slot (0-7) from 8 rows of 5 bit pixel patterns, top  */
+/* row first. Any cell showing character code slot (or slot+8) changes as     */
+/* soon as the new rows arrive - see lcd44780glyphbanks for a tear free way   */
+/* of animating characters that are on screen.                                */
+/*                                                                            */
+/* The address counter is left pointing into CGRAM, so the next lcd44780str   */
+/* or lcd44780chr call sets the cursor position again before writing.         */
+/*                                                                            */
+/* A slot defined here is kept out of the glyph cache used by the bar graph   */
+/* and other widgets until lcd44780glyphbanks is next called.                 */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+{
+	int i,count,args[1];
+	lcd44780dev *dev;
+
+	if (slot >= CGRAMSLOTS) {
+		lcd44780error_fprintf(SLOTOUTOFRANGE);
+		return (SLOTOUTOFRANGE);
+	}
+
+	dev=lcd44780getdev(pi,fd,1);
+	if (dev == NULL) {
+		lcd44780error_fprintf(NOMEMORY);
+		return (NOMEMORY);
+	}
+
+	args[0]=slot;
+	lcd44780reccall(dev,RECDEFCHAR,1,args,(char *)bitmap,8);
+	lcd44780hold(dev);
+	i=lcd44780writecmd4(pi,fd,CGRAMSETADDR|(slot<<3));
+	for (count=0;count<8;count++) {
+		i=lcd44780writedata(pi,fd,bitmap[count]&0x1F);
+	}
+	i=lcd44780release(dev);
+	PROBE4(glyph,pi,fd,slot,8);
+
+	if (dev->cgref[slot] == 0) dev->cgref[slot]=GLYPHPINNED;
+	lcd44780recend(dev,i);
+
+	return (i);
+}
+
+int lcd44780glyphbanks(int pi, int fd, uint8_t setting)
+/******************************************************************************/
+/*                                                                            */
+/* Split CGRAM into two banks for tear free animation (0=OFF, any other       */
+/* value = ON).                                                               */
+/*                                                                            */
+/* With banks on there are 4 logical glyphs, 0-3. Each one lives in slot n    */
+/* and slot n+4; one of the pair is on screen while the other is free to be   */
+/* rewritten by lcd44780stagechar. lcd44780flipchars then moves every cell    */
+/* over to the newly staged slots in one pass. Character codes 0x00-0x0F      */
+/* passed to lcd44780str and lcd44780chr name a logical glyph (code modulo 4) */
+/* and are sent as whichever slot is currently showing it.                    */
+/*                                                                            */
+/* Turning banks on or off also empties the glyph cache used by the widgets.  */
+/*                                                                            */
+/* Each frame costs one command plus 8 data writes per glyph staged, plus one */
+/* data write per cell showing a staged glyph and a set address command for   */
+/* each run of such cells - never more than the size of the display.          */
+/*                                                                            */
+/* Prerequisite - lcd44780init must have been successfully called first.      */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+{
+	int args[1];
+	lcd44780dev *dev;
+
+	dev=lcd44780getdev(pi,fd,1);
+	if (dev == NULL) {
+		lcd44780error_fprintf(NOMEMORY);
+		return (NOMEMORY);
+	}
+
+	args[0]=setting;
+	lcd44780reccall(dev,RECGLYPHBANKS,1,args,NULL,0);
+	dev->banks=(setting == 0) ? 0 : 1;
+	dev->bank=0;
+	dev->staged=0;
+
+	/* The banks own every slot while they are on. Either way, anything the */
+	/* glyph cache held is given up, as the slots are about to be rewritten. */
+
+	memset(dev->cgref,(dev->banks) ? GLYPHPINNED : 0,CGRAMSLOTS);
+	memset(dev->barglyph,-1,sizeof(dev->barglyph));
+	memset(dev->bigglyph,-1,sizeof(dev->bigglyph));
+	memset(dev->synth,-1,sizeof(dev->synth));
+	if (dev->canvas != NULL) {			// Canvas redraws on its next commit
+		memset(dev->canvas->slot,-1,sizeof(dev->canvas->slot));
+		memset(dev->canvas->dirty,1,sizeof(dev->canvas->dirty));
+	}
+	lcd44780recend(dev,0);
+
+	return (0);
+}
+
+int lcd44780stagechar(int pi, int fd, uint8_t glyph, uint8_t *bitmap)
+/******************************************************************************/
+/*                                                                            */
+/* Upload the next frame of logical glyph (0-3) into the bank that isn't on   */
+/* screen. Nothing visible changes until lcd44780flipchars is called.         */
+/* Staging the same glyph again before a flip just replaces the new frame.    */
+/*                                                                            */
+/* Prerequisite - lcd44780glyphbanks must have turned banks on.               */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+{
+	int i,args[1];
+	uint8_t slot;
+	lcd44780dev *dev;
+
+	dev=lcd44780getdev(pi,fd,1);
+	if (dev == NULL) {
+		lcd44780error_fprintf(NOMEMORY);
+		return (NOMEMORY);
+	}
+
+	if (dev->banks == 0) {
+		lcd44780error_fprintf(BANKSOFF);
+		return (BANKSOFF);
+	}
+
+	if (glyph >= BANKGLYPHS) {
+		lcd44780error_fprintf(SLOTOUTOFRANGE);
+		return (SLOTOUTOFRANGE);
+	}
+
+	args[0]=glyph;
+	lcd44780reccall(dev,RECSTAGECHAR,1,args,(char *)bitmap,8);
+	slot=glyph+((((dev->bank>>glyph)&1)^1)*BANKGLYPHS);	// The inactive slot
+	i=lcd44780defchar(pi,fd,slot,bitmap);
+	dev->staged|=(1<<glyph);
+	lcd44780recend(dev,i);
+
+	return (i);
+}
+
+int lcd44780flipchars(int pi, int fd)
+/******************************************************************************/
+/*                                                                            */
+/* Show every glyph staged since the last flip. Each cell on screen showing   */
+/* the old slot of a staged glyph is rewritten with the new slot, in a single */
+/* pass through the display in address order. Glyphs that were not staged     */
+/* are left alone.                                                            */
+/*                                                                            */
+/* Anything drawn with lcd44780draw and not yet committed stays pending - a   */
+/* pending staged glyph is moved to its new slot, and any other pending       */
+/* character is kept, and is sent on the next lcd44780commit as usual.        */
+/*                                                                            */
+/* Prerequisite - lcd44780glyphbanks must have turned banks on.               */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+{
+	int i=0,row,col;
+	uint8_t addr,pending;
+	lcd44780dev *dev;
+
+	dev=lcd44780getdev(pi,fd,1);
+	if (dev == NULL) {
+		lcd44780error_fprintf(NOMEMORY);
+		return (NOMEMORY);
+	}
+
+	if (dev->banks == 0) {
+		lcd44780error_fprintf(BANKSOFF);
+		return (BANKSOFF);
+	}
+
+	lcd44780reccall(dev,RECFLIPCHARS,0,NULL,NULL,0);
+
+	/* Repoint what the framebuffer will show, then send only the cells */
+	/* the display shows the old slot in, keeping any pending character */
+
+	lcd44780hold(dev);
+	for (row=0;row<dev->rows;row++) {
+		for (col=0;col<dev->cols;col++) {
+			addr=rowstart[row]+col;
+			pending=dev->fb[addr];
+			if (lcd44780flipped(dev,pending)) pending^=BANKGLYPHS;
+			if (lcd44780flipped(dev,dev->ddram[addr])) {
+				if (dev->ac != addr) {
+					i=lcd44780writecmd4(dev->pi,dev->fd,DDRAMSETADDR|addr);
+				}
+				else COUNT(dev,addrskipped,1);
+				i=lcd44780writedata(dev->pi,dev->fd,(dev->ddram[addr]&0x07)^BANKGLYPHS);
+			}
+			dev->fb[addr]=pending;
+		}
+	}
+	i=lcd44780release(dev);
+
+	dev->bank^=dev->staged;
+	dev->staged=0;
+	lcd44780recend(dev,i);
 
 	return (i);
 }
+
+int lcd44780setbackpack(int pi, int fd, uint8_t backpack)
+/******************************************************************************/
+/*                                                                            */
+/* Say which backpack the display is connected through, if it isn't a         */
+/* PCF8574 (LCD44780PCF8574):                                                 */
+/*                                                                            */
+/*      LCD44780MCP23008  - MCP23008 in 4 bit mode (e.g. Adafruit I2C/SPI     */
+/*                          backpack), I2C address 0x20 upwards               */
+/*      LCD44780MCP23017  - MCP23017 in 8 bit mode, D0-D7 on port A and RS,   */
+/*                          RW, E and backlight on GPB7, GPB6, GPB5 and GPB4  */
+/*      LCD44780RGBPLATE  - Adafruit RGB LCD plate (MCP23017, 4 bit mode,     */
+/*                          backlight colour set with lcd44780rgb)            */
+/*                                                                            */
+/* The backpack's usual wiring is selected too - lcd44780setpins can change   */
+/* it afterwards. Call before lcd44780init, which sets the backpack up.       */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+{
+	lcd44780dev *dev;
+	static const lcd44780driver *drivers[4]={&lcd44780pcf8574drv, &lcd44780mcp23008drv,
+						 &lcd44780mcp23017drv, &lcd44780rgbplatedrv};
+	static lcd44780pinmap maps[4]={LCD44780PINSPCF8574, LCD44780PINSMCP23008,
+				       LCD44780PINSMCP23017, LCD44780PINSRGBPLATE};
+
+	if (backpack > LCD44780RGBPLATE) {
+		lcd44780error_fprintf(BADSETTING);
+		return (BADSETTING);
+	}
+
+	dev=lcd44780getdev(pi,fd,1);
+	if (dev == NULL) {
+		lcd44780error_fprintf(NOMEMORY);
+		return (NOMEMORY);
+	}
+
+	lcd44780flush(dev);			// Anything queued goes the old way
+	dev->drv=drivers[backpack];
+	dev->backpack=backpack;
+	dev->rgb=RGBALL;
+	lcd44780mappins(dev,&maps[backpack]);
+
+	return (0);
+}
+
+int lcd44780setbusclock(int pi, int fd, uint32_t hz)
+/******************************************************************************/
+/*                                                                            */
+/* Tell the library the clock of the I2C bus the display's backpack is on, if */
+/* it isn't the Raspberry Pi's usual 100kHz. The whole of a string goes to    */
+/* the backpack in one write, so on a bus faster than about 240kHz enable     */
+/* would rise for the next character before the HD44780U had finished with    */
+/* the last (37us). From then on each character is followed by as many idle   */
+/* bytes as it takes - 1 at 400kHz, 4 at 1MHz. For the simulator this sets    */
+/* the clock it models too.                                                   */
+/*                                                                            */
+/* Returns 0, or BADSETTING if hz is 0 or the display isn't on an I2C bus.    */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+{
+	lcd44780dev *dev;
+
+	dev=lcd44780getdev(pi,fd,1);
+	if (dev == NULL) {
+		lcd44780error_fprintf(NOMEMORY);
+		return (NOMEMORY);
+	}
+
+	if ((hz == 0) || ((dev->backpack > LCD44780RGBPLATE) &&
+	    (dev->backpack != LCD44780PIGS) && (dev->backpack != LCD44780SIM))) {
+		lcd44780error_fprintf(BADSETTING);
+		return (BADSETTING);
+	}
+
+	lcd44780flush(dev);			// Anything queued was padded for the old clock
+	if (dev->backpack == LCD44780SIM) dev->hz=hz;
+	dev->pad=lcd44780buspad(hz);
+
+	return (0);
+}
+
+int lcd44780setpins(int pi, int fd, lcd44780pinmap *map)
+/******************************************************************************/
+/*                                                                            */
+/* Tell the library how the display's backpack is wired, if it isn't the      */
+/* usual PCF8574 arrangement (LCD44780PINSPCF8574). Each line is given as the */
+/* expander pin (0-7) it is connected to, e.g.                                */
+/*                                                                            */
+/*      lcd44780pinmap map=LCD44780PINSLOWDATA;                               */
+/*      lcd44780setpins(pi,fd,&map);                                          */
+/*                                                                            */
+/* Call before lcd44780init. Wirings with the data lines in order on P4-P7 or */
+/* P0-P3 can use the vector encoders; any other is sent from the strobe table.*/
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+{
+	int count;
+	uint8_t used=0x00, *pin;
+	lcd44780dev *dev;
+
+	dev=lcd44780getdev(pi,fd,1);
+	if (dev == NULL) {
+		lcd44780error_fprintf(NOMEMORY);
+		return (NOMEMORY);
+	}
+
+	/* Each line needs a pin of its own */
+
+	pin=(uint8_t *)map;
+	for (count=0;count<8;count++) {
+		if ((pin[count] > 7) || (used&(1<<pin[count]))) {
+			lcd44780error_fprintf(BADSETTING);
+			return (BADSETTING);
+		}
+		used|=1<<pin[count];
+	}
+	if (map->blinvert > 1) {
+		lcd44780error_fprintf(BADSETTING);
+		return (BADSETTING);
+	}
+
+	lcd44780mappins(dev,map);
+	return (0);
+}
+
+int lcd44780sync(int pi, int fd, uint32_t *write)
+/******************************************************************************/
+/*                                                                            */
+/* Send anything queued for the display and wait until it has arrived.        */
+/*                                                                            */
+/* Returns the first error reported since the last call (0 if none). Drivers  */
+/* that don't wait for each write (lcd44780pigsopen) report errors late, so   */
+/* if write isn't NULL it is set to the number of the write that failed,      */
+/* counting from 1 for the first since the display was opened.                */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+{
+	int i;
+	lcd44780dev *dev;
+
+	dev=lcd44780getdev(pi,fd,0);
+	if (dev == NULL) return (0);
+
+	i=lcd44780flush(dev);
+	if (dev->drv->sync != NULL) dev->drv->sync(dev);
+
+	if ((i < 0) && (dev->syncerr == 0)) dev->syncerr=i;
+	i=dev->syncerr;
+	if (write != NULL) *write=dev->syncerrseq;
+	dev->syncerr=0;
+	dev->syncerrseq=0;
+
+	return (i);
+}
+
+int lcd44780close(int pi, int fd)
+/******************************************************************************/
+/*                                                                            */
+/* Release the state the library keeps for a display. Call before i2c_close.  */
+/* The display itself is left as it is. Displays opened by the library (e.g.  */
+/* lcd44780spiopen) are closed too.                                           */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+{
+	int count;
+
+	for (count=0;count<MAXDEVS;count++) {
+		if ((lcddevs[count] != NULL) && (lcddevs[count]->pi == pi) && (lcddevs[count]->fd == fd)) {
+			if (lastdev == lcddevs[count]) lastdev=NULL;
+			lcd44780flush(lcddevs[count]);
+			lcd44780vcdend(lcddevs[count]);
+			if (lcddevs[count]->rec != NULL) fflush(lcddevs[count]->rec);
+			if (lcddevs[count]->drv->end != NULL) lcddevs[count]->drv->end(lcddevs[count]);
+			free(lcddevs[count]->canvas);
+			free(lcddevs[count]);
+			lcddevs[count]=NULL;
+		}
+	}
+
+	return (0);
+}
@@ -19,6 +19,101 @@
 /* 44780 LCD I2C device address */
 
 #define LCD44780ADDR      			0x27    // I2C address of LCD.
+#define LCD44780NOPI      			-1      // pi for displays not reached through pigpiod
+
+/* Character ROMs for lcd44780setrom */
+
+#define LCD44780ROMA00				0	// Japanese (HD44780UA00)
+#define LCD44780ROMA02				1	// European (HD44780UA02)
+#define LCD44780ROMRAW				2	// No translation - bytes are sent unchanged
+
+/* Backpack wiring - the expander pin (0-7) each HD44780U line is on */
+
+typedef struct {
+	uint8_t d4,d5,d6,d7;				// Data lines (4 bit mode)
+	uint8_t rs,rw,en,bl;				// Register set, read/write, enable and backlight
+	uint8_t blinvert;				// 1 if the backlight is lit when its pin is low
+} lcd44780pinmap;
+
+#define LCD44780PINSPCF8574			{4,5,6,7,0,1,2,3,0}	// The usual backpack (default)
+#define LCD44780PINSPCF8574INV			{4,5,6,7,0,1,2,3,1}	// As above, backlight active low
+#define LCD44780PINSLOWDATA			{0,1,2,3,4,5,6,7,0}	// Data on P0-P3, control on P4-P7
+#define LCD44780PINSMCP23008			{3,4,5,6,1,0,2,7,0}	// Adafruit MCP23008 backpack (RW unused)
+#define LCD44780PINSMCP23017			{0,1,2,3,7,6,5,4,0}	// Port B of an 8 bit MCP23017 (D4-D7 unused)
+#define LCD44780PINSRGBPLATE			{4,3,2,1,7,6,5,0,1}	// Port B of the Adafruit RGB plate (blue LED)
+
+/* Counters kept for each display, for lcd44780stats */
+
+typedef struct {
+	uint64_t sends;				// Writes to the bus (transport calls)
+	uint64_t failed;			// of which failed
+	uint64_t bytes;				// Bytes written to the bus
+	uint64_t commands;			// Instructions and
+	uint64_t data;				// data bytes sent to the HD44780U
+	uint64_t addrsent;			// Set address instructions sent
+	uint64_t addrskipped;			// and left out, the address counter already being there
+	uint64_t sleepns;			// Nanoseconds (while timing is on - lcd44780settiming) spent in delays,
+	uint64_t busns;				// in writes to the bus
+	uint64_t encodens;			// and encoding bytes to send
+} lcd44780counters;
+
+/* Operations and latencies for lcd44780latency */
+
+#define LCD44780OPSTR				0	// lcd44780str
+#define LCD44780OPCHR				1	// lcd44780chr
+#define LCD44780OPCLEARLINE			2	// lcd44780clearline
+#define LCD44780OPCLEAR				3	// lcd44780clear
+#define LCD44780OPCOMMIT			4	// lcd44780commit (from the first lcd44780draw since the last one)
+#define LCD44780OPINIT				5	// lcd44780init
+#define LCD44780OPS				6
+
+#define LCD44780LATVISIBLE			0	// From the call until everything has been sent, waits included
+#define LCD44780LATBUS				1	// Time spent writing to the bus alone
+#define LCD44780PRIORITIES			4	// Priority classes for lcd44780setpriority (0-3)
+
+typedef struct {
+	uint64_t count;				// Operations timed
+	uint64_t p50;				// Median,
+	uint64_t p99;				// 99th and
+	uint64_t p999;				// 99.9th percentiles (to within 1/16th)
+	uint64_t max;				// and longest, in nanoseconds
+} lcd44780percentiles;
+
+/* Backpacks for lcd44780setbackpack */
+
+#define LCD44780PCF8574				0	// PCF8574, 4 bit mode (default)
+#define LCD44780MCP23008			1	// MCP23008, 4 bit mode
+#define LCD44780MCP23017			2	// MCP23017, 8 bit mode
+#define LCD44780RGBPLATE			3	// Adafruit RGB LCD plate (MCP23017, 4 bit mode)
+#define LCD44780SPI595				4	// 74HC595 on SPI, 4 bit mode (see lcd44780spiopen)
+#define LCD44780GPIO				5	// Wired to GPIO lines, 4 or 8 bit mode (see lcd44780gpioopen)
+#define LCD44780CHARLCD				6	// Kernel hd44780 driver's /dev/lcd (see lcd44780charlcdopen)
+#define LCD44780PIGS				7	// PCF8574 through the library's own pigpiod client (see lcd44780pigsopen)
+#define LCD44780SIM				8	// Simulated PCF8574 backpack and display (see lcd44780simopen)
+
+/* pigpiod client modes for lcd44780pigsmode */
+
+#define LCD44780PIGSWRITE			0	// Each frame as one i2c_write_device (default)
+#define LCD44780PIGSZIP				1	// Each frame as one i2c_zip sequence
+
+/* Clocks for lcd44780setclock */
+
+#define LCD44780CLOCKREAL			0	// CLOCK_MONOTONIC and nanosleep (default)
+#define LCD44780CLOCKVIRTUAL			1	// Waits take no time, but move the clock on
+
+/* Strobe encoders for lcd44780setencoder */
+
+#define LCD44780ENCAUTO				0	// Fastest this CPU supports for short runs
+#define LCD44780ENCSCALAR			1	// Table driven, any CPU
+#define LCD44780ENCSSE2				2	// x86 SSE2
+#define LCD44780ENCAVX2				3	// x86 AVX2
+#define LCD44780ENCNEON				4	// ARM NEON
+
+/* Bar graph types for lcd44780bar */
+
+#define LCD44780BARRIGHT			0	// Horizontal, growing to the right
+#define LCD44780BARUP				1	// Vertical, growing upwards
+#define LCD44780BARBIPOLAR			2	// Horizontal, growing either way from the centre
 
 /* Declare 44780 LCD library functions as externals */
 
@@ -34,3 +129,46 @@ extern int lcd44780setdisplay(int pi, int fd, uint8_t mode, uint8_t blink, uint8
 extern int lcd44780clear(int pi, int fd);
 extern int lcd44780home(int pi, int fd);
 extern int lcd44780init(int pi, int fd, int rows, int cols);
+extern int lcd44780setrom(int pi, int fd, uint8_t rom);
+extern int lcd44780defchar(int pi, int fd, uint8_t slot, uint8_t *bitmap);
+extern int lcd44780glyphbanks(int pi, int fd, uint8_t setting);
+extern int lcd44780stagechar(int pi, int fd, uint8_t glyph, uint8_t *bitmap);
+extern int lcd44780flipchars(int pi, int fd);
+extern int lcd44780sync(int pi, int fd, uint32_t *write);
+extern int lcd44780close(int pi, int fd);
+extern int lcd44780setbackpack(int pi, int fd, uint8_t backpack);
+extern int lcd44780setpins(int pi, int fd, lcd44780pinmap *map);
+extern int lcd44780setbusclock(int pi, int fd, uint32_t hz);
+extern int lcd44780rgb(int pi, int fd, uint8_t red, uint8_t green, uint8_t blue);
+extern int lcd44780spiopen(char *device, uint32_t hz);
+extern int lcd44780spimock(int fd);
+extern int lcd44780gpioopen(char *chip, int rs, int en, int bl, int *data, int bits);
+extern int lcd44780gpiomock(int fd, int bits);
+extern int lcd44780charlcdopen(char *device);
+extern int lcd44780pigsopen(char *host, char *port, unsigned bus, unsigned addr);
+extern int lcd44780pigsmode(int fd, uint8_t mode);
+extern int lcd44780simopen(uint32_t hz);
+extern int lcd44780simoverhead(int fd, uint32_t ns);
+extern int lcd44780setclock(uint8_t id);
+extern uint64_t lcd44780clock(void);
+extern int lcd44780stats(int pi, int fd, lcd44780counters *counters, uint8_t reset);
+extern int lcd44780statsdump(int pi, int fd, FILE *f, uint32_t seconds);
+extern int lcd44780settiming(uint8_t setting);
+extern int lcd44780setpriority(int pi, int fd, uint8_t priority);
+extern int lcd44780latency(int pi, int fd, uint8_t op, uint8_t kind, lcd44780percentiles *p, uint8_t reset);
+extern int lcd44780prioritylatency(uint8_t priority, uint8_t op, uint8_t kind, lcd44780percentiles *p, uint8_t reset);
+extern int lcd44780trace(uint32_t entries);
+extern int lcd44780traceexport(FILE *f);
+extern int lcd44780vcd(int pi, int fd, FILE *f);
+extern int lcd44780record(int pi, int fd, FILE *f);
+extern int lcd44780setencoder(uint8_t id);
+extern int lcd44780encode(int pi, int fd, uint8_t rs, char *src, int len, uint8_t *out);
+extern int lcd44780draw(int pi, int fd, char *writebuf, uint8_t row, uint8_t col);
+extern int lcd44780commit(int pi, int fd);
+extern int lcd44780bar(int pi, int fd, uint8_t type, uint8_t row, uint8_t col, uint8_t len, int value, int max);
+extern int lcd44780bignum(int pi, int fd, char *writebuf, uint8_t row, uint8_t col, uint8_t height);
+extern int lcd44780canvasinit(int pi, int fd, uint8_t row, uint8_t col, uint8_t width, uint8_t height);
+extern int lcd44780plot(int pi, int fd, int x, int y, uint8_t setting);
+extern int lcd44780canvasclear(int pi, int fd);
+extern int lcd44780canvasscroll(int pi, int fd, uint8_t pixels);
+extern int lcd44780canvascommit(int pi, int fd);
@@ -0,0 +1,299 @@
+/******************************************************************************/
+/*                                                                            */
+/* Workload benchmark for the                                                 */
+/* 44780 LCD display library for I2C bus.                                     */
+/*                                                                            */
+/* Runs a set of standard workloads against the simulated display             */
+/* (lcd44780simopen) on the virtual clock, for each of a few bus models, and  */
+/* reports the writes to the bus, the bytes written, the time the display     */
+/* would take on that bus and the frames per second it could manage. No       */
+/* display (or pigpiod) is needed, and as the clock is virtual the results    */
+/* are the same on every run and every machine.                               */
+/*                                                                            */
+/* Each result also gives the timing violations the simulated HD44780U saw -  */
+/* bytes sent before it had finished with the last. A workload with any is    */
+/* marked (with a * in the text output), as the display couldn't really take  */
+/* its bytes that fast, and the benchmark returns 1.                          */
+/*                                                                            */
+/* Workloads (each frame is one update of the display):                       */
+/*                                                                            */
+/*      redraw     every row rewritten with lcd44780str                       */
+/*      chrstorm   one lcd44780chr at random, as in lcd44780test              */
+/*      clock      HH:MM:SS ticking a second a frame, drawn and committed     */
+/*      bigclock   MM:SS in 4 row big numerals ticking a second a frame       */
+/*      ticker     a message scrolling along the bottom row                   */
+/*      bars       four bar graphs moving                                     */
+/*      logtail    a new line of log each frame, the others scrolling up      */
+/*                                                                            */
+/* Usage: lcd44780bench [-n frames] [-m model] [-c | -j]                      */
+/*                                                                            */
+/*      -n  frames per workload (default 1000)                                */
+/*      -m  only run one bus model: 100k, 400k, 1M or pigpiod                 */
+/*      -c  CSV output                                                        */
+/*      -j  JSON output, one object per line                                  */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+#include "lcd44780.h"
+#include "lcd44780sim.h"
+
+#define BENCHROWS               4       // Display used for every workload
+#define BENCHCOLS               20
+
+#define BENCHTEXT               0       // Output formats
+#define BENCHCSV                1
+#define BENCHJSON               2
+
+typedef struct {
+	char *name;
+	uint32_t hz;				// I2C bus clock
+	uint32_t overhead;			// Nanoseconds added to every write
+} benchmodel;
+
+typedef struct {
+	char *name;
+	void (*frame)(int pi, int fd, int n);	// Draw frame n
+} benchworkload;
+
+static const benchmodel models[]={
+	{"100k",100000,0},
+	{"400k",400000,0},
+	{"1M",1000000,0},
+	{"pigpiod",100000,100000},		// 100kHz plus a Pi 3B+'s round trip to pigpiod
+};
+#define BENCHMODELS             (sizeof(models)/sizeof(models[0]))
+
+static void redraw(int pi, int fd, int n) {
+/******************************************************************************/
+/*                                                                            */
+/* Rewrite every row, each with different text to the last frame.             */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	int row,col;
+	char line[BENCHCOLS+1];
+
+	for (row=0;row<BENCHROWS;row++) {
+		for (col=0;col<BENCHCOLS;col++) line[col]='A'+(n+row+col)%26;
+		line[BENCHCOLS]='\0';
+		lcd44780str(pi,fd,line,row+1,1);
+	}
+	return;
+}
+
+static void chrstorm(int pi, int fd, int n) {
+/******************************************************************************/
+/*                                                                            */
+/* A random character at a random place.                                      */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	int x,y;
+	char c[2];
+
+	(void)n;
+	x=(rand()%BENCHCOLS)+1;
+	y=(rand()%BENCHROWS)+1;
+	c[0]=(rand()%95)+32;
+	c[1]='\0';
+	lcd44780chr(pi,fd,c,y,x);
+	return;
+}
+
+static void hhmmss(int pi, int fd, int n) {
+/******************************************************************************/
+/*                                                                            */
+/* Time of day, a second on from the last frame.                              */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	char t[16];
+
+	sprintf(t,"%02d:%02d:%02d",(n/3600)%24,(n/60)%60,n%60);
+	lcd44780draw(pi,fd,t,1,7);
+	lcd44780commit(pi,fd);
+	return;
+}
+
+static void bigclock(int pi, int fd, int n) {
+/******************************************************************************/
+/*                                                                            */
+/* Minutes and seconds in big numerals, a second on from the last frame.      */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	char t[16];
+
+	sprintf(t,"%02d:%02d",(n/60)%60,n%60);
+	lcd44780bignum(pi,fd,t,1,2,4);
+	return;
+}
+
+static void ticker(int pi, int fd, int n) {
+/******************************************************************************/
+/*                                                                            */
+/* The message moved one place left along the bottom row.                     */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	static const char *msg="Boiler 2 pressure high - check relief valve - call 0123 456789 *** ";
+	int col,len;
+	char line[BENCHCOLS+1];
+
+	len=strlen(msg);
+	for (col=0;col<BENCHCOLS;col++) line[col]=msg[(n+col)%len];
+	line[BENCHCOLS]='\0';
+	lcd44780draw(pi,fd,line,BENCHROWS,1);
+	lcd44780commit(pi,fd);
+	return;
+}
+
+static void bars(int pi, int fd, int n) {
+/******************************************************************************/
+/*                                                                            */
+/* Four bar graphs, each rising and falling at its own rate.                  */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	int row,v;
+
+	for (row=0;row<BENCHROWS;row++) {
+		v=(n*(row+1)*3+row*25)%200;
+		if (v > 100) v=200-v;
+		lcd44780bar(pi,fd,LCD44780BARRIGHT,row+1,1,BENCHCOLS,v,100);
+	}
+	return;
+}
+
+static void logtail(int pi, int fd, int n) {
+/******************************************************************************/
+/*                                                                            */
+/* Scroll the log up a line and add a new one at the bottom.                  */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	static char lines[BENCHROWS][BENCHCOLS+1];
+	static const char *events[4]={"door open","temp ok","pump start","link up"};
+	int row;
+
+	if (n == 0) for (row=0;row<BENCHROWS;row++) lines[row][0]='\0';
+
+	for (row=0;row<BENCHROWS-1;row++) strcpy(lines[row],lines[row+1]);
+	snprintf(lines[BENCHROWS-1],BENCHCOLS+1,"%02u:%02u %-14.14s",(unsigned)(n/60)%60,(unsigned)n%60,events[n%4]);
+
+	for (row=0;row<BENCHROWS;row++) lcd44780draw(pi,fd,lines[row],row+1,1);
+	lcd44780commit(pi,fd);
+	return;
+}
+
+static const benchworkload workloads[]={
+	{"redraw",redraw},
+	{"chrstorm",chrstorm},
+	{"clock",hhmmss},
+	{"bigclock",bigclock},
+	{"ticker",ticker},
+	{"bars",bars},
+	{"logtail",logtail},
+};
+#define BENCHWORKLOADS          (sizeof(workloads)/sizeof(workloads[0]))
+
+int main(int argc, char *argv[]) {
+	int opt, frames=1000, format=BENCHTEXT, pi=LCD44780NOPI, fd, n, ran=0, late=0;
+	unsigned m, w;
+	char *only=NULL;
+	uint32_t violations;
+	uint64_t start, ns;
+	double fps;
+	lcd44780counters c;
+
+	while ((opt=getopt(argc,argv,"n:m:cj")) != -1) {
+		switch (opt) {
+		case 'n':
+			frames=atoi(optarg);
+			break;
+		case 'm':
+			only=optarg;
+			break;
+		case 'c':
+			format=BENCHCSV;
+			break;
+		case 'j':
+			format=BENCHJSON;
+			break;
+		default:
+			frames=0;
+		}
+	}
+	if (frames < 1) {
+		fprintf(stderr,"Usage: %s [-n frames] [-m 100k|400k|1M|pigpiod] [-c | -j]\n",argv[0]);
+		exit(1);
+	}
+
+	for (m=0;m<BENCHMODELS;m++) if ((only == NULL) || (strcmp(only,models[m].name) == 0)) ran++;
+	if (ran == 0) {
+		fprintf(stderr,"No bus model called %s\n",only);
+		exit(1);
+	}
+
+	lcd44780setclock(LCD44780CLOCKVIRTUAL);
+
+	if (format == BENCHCSV) printf("model,hz,overhead_ns,workload,frames,writes,bytes,ns,fps,violations\n");
+	if (format == BENCHTEXT) {
+		printf("%-8s %-9s %7s %8s %9s %12s %9s %11s %10s\n",
+			"model","workload","frames","writes","bytes","time ms","fps","bytes/frame","violations");
+	}
+
+	for (m=0;m<BENCHMODELS;m++) {
+		if ((only != NULL) && (strcmp(only,models[m].name) != 0)) continue;
+
+		for (w=0;w<BENCHWORKLOADS;w++) {
+			fd=lcd44780simopen(models[m].hz);	// A fresh display for each workload
+			if (fd < 0) {
+				fprintf(stderr,"Can't open the simulated display (%d)\n",fd);
+				exit(1);
+			}
+			lcd44780simoverhead(fd,models[m].overhead);
+			lcd44780init(pi,fd,BENCHROWS,BENCHCOLS);
+			srand(1);
+
+			lcd44780stats(pi,fd,&c,1);		// Count the workload alone
+			start=lcd44780clock();
+			for (n=0;n<frames;n++) workloads[w].frame(pi,fd,n);
+			ns=lcd44780clock()-start;
+			lcd44780stats(pi,fd,&c,0);
+			violations=lcd44780simget(fd)->violations;
+			lcd44780close(pi,fd);
+			if (violations > 0) late=1;
+
+			fps=(ns > 0) ? frames*1e9/ns : 0.0;
+
+			if (format == BENCHCSV) {
+				printf("%s,%u,%u,%s,%d,%llu,%llu,%llu,%.2f,%u\n",models[m].name,models[m].hz,
+					models[m].overhead,workloads[w].name,frames,(unsigned long long)c.sends,
+					(unsigned long long)c.bytes,(unsigned long long)ns,fps,violations);
+			}
+			else if (format == BENCHJSON) {
+				printf("{\"model\":\"%s\",\"hz\":%u,\"overhead_ns\":%u,\"workload\":\"%s\",\"frames\":%d,"
+					"\"writes\":%llu,\"bytes\":%llu,\"ns\":%llu,\"fps\":%.2f,\"violations\":%u}\n",
+					models[m].name,models[m].hz,models[m].overhead,workloads[w].name,frames,
+					(unsigned long long)c.sends,(unsigned long long)c.bytes,(unsigned long long)ns,fps,
+					violations);
+			}
+			else {
+				printf("%-8s %-9s %7d %8llu %9llu %12.3f %9.1f %11.1f %10u%s\n",models[m].name,
+					workloads[w].name,frames,(unsigned long long)c.sends,(unsigned long long)c.bytes,
+					ns/1e6,fps,(double)c.bytes/frames,violations,(violations > 0) ? " *" : "");
+			}
+		}
+	}
+	if ((late) && (format == BENCHTEXT)) printf("* timing violations - the display couldn't keep up at this rate\n");
+	exit(late);
+}
@@ -0,0 +1,295 @@
+/******************************************************************************/
+/*                                                                            */
+/* Kernel auxdisplay driver for the HD44780U LCD display library - for        */
+/* systems where the kernel's hd44780 driver owns the display and provides    */
+/* /dev/lcd (the charlcd interface), doing all the strobing and timing.       */
+/*                                                                            */
+/* Instead of strobe bytes, the instructions and data the library would send  */
+/* are turned into characters and charlcd escape sequences:                   */
+/*                                                                            */
+/*      \f                 clear display           \x1b[H      cursor home    */
+/*      \x1b[Lx<x>y<y>;    move cursor             \x1b[LD/Ld  display on/off */
+/*      \x1b[LG<c><hex>;   define character c      \x1b[LC/Lc  cursor on/off  */
+/*      \x1b[Ll/Lr         shift cursor            \x1b[LB/Lb  blink on/off   */
+/*      \x1b[LL/LR         shift display           \x1b[L+/L-  backlight      */
+/*                                                                            */
+/* and each frame (a string, a commit ...) is a single write(). The kernel    */
+/* initialises the display itself, and can't do 8 bit mode or decrementing    */
+/* entry modes, or show character 0x1B (an escape) - a space is sent instead. */
+/* Codes 0x08-0x0F are sent as their CGRAM aliases 0x00-0x07, as the kernel   */
+/* would take most of them as control characters. As the kernel keeps to the  */
+/* HD44780U's timings, the library doesn't add delays of its own.             */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+#include "lcd44780int.h"
+#include <fcntl.h>
+#include <sys/uio.h>
+
+/* charlcd internal library functions */
+
+static void lcd44780charlcdput(lcd44780dev *dev, char *seq, int len) {
+/******************************************************************************/
+/*                                                                            */
+/* Add to the frame being built, only sending it early if the queue fills.    */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	if (dev->outlen+len > OUTSIZE) lcd44780flush(dev);
+
+	memcpy(dev->out+dev->outlen,seq,len);
+	dev->outlen+=len;
+	return;
+}
+
+static void lcd44780charlcdcmd(lcd44780dev *dev, uint8_t cmd) {
+/******************************************************************************/
+/*                                                                            */
+/* Translate an instruction. Setting an address just moves the address        */
+/* counter - the cursor is placed when characters are written there.          */
+/* Function and entry mode settings are the kernel's business.                */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	char seq[16];
+
+	if ((cmd & DDRAMSETADDR) || (cmd & CGRAMSETADDR) || (cmd & FUNCTIONSET)) {
+		return;
+	}
+	else if (cmd & CURSORMOVE) {
+		if (cmd & GODISPLAY) lcd44780charlcdput(dev,(cmd & GORIGHT) ? "\x1b[LR" : "\x1b[LL",4);
+		else lcd44780charlcdput(dev,(cmd & GORIGHT) ? "\x1b[Lr" : "\x1b[Ll",4);
+		dev->cursor=ACUNKNOWN;
+	}
+	else if (cmd & DISPLAYCONTROL) {
+		sprintf(seq,"\x1b[L%c\x1b[L%c\x1b[L%c",(cmd & DISPLAYON) ? 'D' : 'd',
+			(cmd & CURSORON) ? 'C' : 'c',(cmd & BLINKON) ? 'B' : 'b');
+		lcd44780charlcdput(dev,seq,12);
+	}
+	else if (cmd & ENTRYMODESET) {
+		return;
+	}
+	else if (cmd & CURSORHOME) {
+		lcd44780charlcdput(dev,"\x1b[H",3);
+		dev->cursor=0x00;
+	}
+	else if (cmd & CLEARDISPLAY) {
+		lcd44780charlcdput(dev,"\f",1);
+		dev->cursor=0x00;
+	}
+	return;
+}
+
+static int lcd44780charlcdglyphs(lcd44780dev *dev, char *seq) {
+/******************************************************************************/
+/*                                                                            */
+/* Put the definitions of the characters written since they were last sent    */
+/* into seq (room for 22 bytes a character), returning their length.          */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	int slot,count,len=0;
+
+	for (slot=0;slot<CGRAMSLOTS;slot++) {
+		if (dev->cgpending & (1<<slot)) {
+			sprintf(seq+len,"\x1b[LG%c",'0'+slot);
+			for (count=0;count<8;count++) sprintf(seq+len+5+2*count,"%02x",dev->cgram[slot][count]&0x1F);
+			seq[len+21]=';';
+			len+=22;
+		}
+	}
+	dev->cgpending=0;
+	return(len);
+}
+
+static void lcd44780charlcdqueueglyphs(lcd44780dev *dev) {
+/******************************************************************************/
+/*                                                                            */
+/* Queue the definitions of characters written since they were last sent.     */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	char seq[CGRAMSLOTS*22];
+
+	if (dev->cgpending) lcd44780charlcdput(dev,seq,lcd44780charlcdglyphs(dev,seq));
+	return;
+}
+
+static void lcd44780charlcdencode(lcd44780dev *dev, uint8_t rs, uint8_t *src, int len) {
+/******************************************************************************/
+/*                                                                            */
+/* Translate a run of instructions or data. Data goes wherever the address    */
+/* counter says - characters at the cursor, moving it first if it isn't       */
+/* there already (written off the edge of the display, they're dropped), or   */
+/* character definitions, sent whole once something else comes along.         */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	int count,row,col,ac,start;
+	char seq[16];
+
+	if ((rs == 0) || ((dev->ac & CGRAMAC) == 0)) lcd44780charlcdqueueglyphs(dev);
+
+	if (rs == 0) {
+		for (count=0;count<len;count++) lcd44780charlcdcmd(dev,src[count]);
+		return;
+	}
+
+	ac=dev->ac;
+	for (count=0;(count<len)&&(ac!=ACUNKNOWN);count++) {
+		if (ac & CGRAMAC) {
+			dev->cgpending|=1<<((ac&0x3F)>>3);
+		}
+		else {
+			for (row=0;row<dev->rows;row++) {		// Where is it on the display?
+				start=lcd44780ddaddr(row,0);
+				if ((ac >= start) && (ac < start+dev->cols)) break;
+			}
+
+			if (row < dev->rows) {
+				col=ac-start;
+				if (ac != dev->cursor) {
+					sprintf(seq,"\x1b[Lx%dy%d;",col,row);
+					lcd44780charlcdput(dev,seq,strlen(seq));
+				}
+
+				seq[0]=src[count];
+				if ((uint8_t)seq[0] == 0x1B) seq[0]=' ';
+				else if (((uint8_t)seq[0] >= 0x08) && ((uint8_t)seq[0] <= 0x0F)) seq[0]&=0x07;
+				lcd44780charlcdput(dev,seq,1);
+
+				dev->cursor=(col+1 < dev->cols) ? ac+1 : ACUNKNOWN;
+			}
+		}
+		ac=lcd44780nextaddr(dev,ac);
+	}
+	return;
+}
+
+static void lcd44780charlcdnibble(lcd44780dev *dev, uint8_t data) {
+/******************************************************************************/
+/*                                                                            */
+/* The kernel has already initialised the display - nothing to do.            */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	(void)data;
+	dev->cursor=ACUNKNOWN;
+	return;
+}
+
+static void lcd44780charlcdlight(lcd44780dev *dev) {
+/******************************************************************************/
+/*                                                                            */
+/* Backlight on or off.                                                       */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	lcd44780charlcdqueueglyphs(dev);
+	lcd44780charlcdput(dev,(dev->blon) ? "\x1b[L+" : "\x1b[L-",4);
+	return;
+}
+
+static int lcd44780charlcdsend(lcd44780dev *dev, uint8_t *buf, int len) {
+/******************************************************************************/
+/*                                                                            */
+/* The whole frame in one write, finishing with any characters defined at     */
+/* the end of it.                                                             */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	char seq[CGRAMSLOTS*22];
+	struct iovec iov[2];
+
+	iov[0].iov_base=buf;
+	iov[0].iov_len=len;
+	iov[1].iov_base=seq;
+	iov[1].iov_len=lcd44780charlcdglyphs(dev,seq);
+
+	return((writev(dev->fd,iov,2) < 0) ? -1 : 0);
+}
+
+static void lcd44780charlcdend(lcd44780dev *dev) {
+/******************************************************************************/
+/*                                                                            */
+/* Close the device.                                                          */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	close(dev->fd);
+	return;
+}
+
+const lcd44780driver lcd44780charlcddrv={0, NULL, lcd44780charlcdencode, lcd44780charlcdnibble, lcd44780charlcdlight, lcd44780charlcdsend, lcd44780charlcdend, NULL, 1};
+
+/* charlcd external library functions */
+
+int lcd44780charlcdopen(char *device)
+/******************************************************************************/
+/*                                                                            */
+/* Open a display driven by the kernel's hd44780 auxdisplay driver, e.g.      */
+/*                                                                            */
+/*      fd=lcd44780charlcdopen("/dev/lcd");                                   */
+/*      lcd44780init(LCD44780NOPI,fd,2,16);                                   */
+/*                                                                            */
+/* lcd44780init just sets up the library's state and puts the display in      */
+/* the usual mode - the rows and columns given must match the kernel's.       */
+/* Any file or pipe can stand in for /dev/lcd when testing.                   */
+/*                                                                            */
+/* Returns the handle to use (with pi=LCD44780NOPI) for the display,          */
+/* NOMEMORY, or NODEVICE if it can't be opened. lcd44780close closes it.      */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+{
+	int fd;
+	lcd44780dev *dev;
+
+	fd=open(device,O_WRONLY|O_CLOEXEC);
+	if (fd < 0) {
+		lcd44780error_fprintf(NODEVICE);
+		return (NODEVICE);
+	}
+
+	dev=lcd44780getdev(LCD44780NOPI,fd,1);
+	if (dev == NULL) {
+		close(fd);
+		lcd44780error_fprintf(NOMEMORY);
+		return (NOMEMORY);
+	}
+
+	dev->drv=&lcd44780charlcddrv;
+	dev->backpack=LCD44780CHARLCD;
+	dev->cursor=ACUNKNOWN;
+
+	return (fd);
+}
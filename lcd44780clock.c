@@ -0,0 +1,122 @@
+/******************************************************************************/
+/*                                                                            */
+/* Clock for the HD44780U LCD display library for I2C bus.                    */
+/*                                                                            */
+/* Every wait the library makes goes through here. The real clock is          */
+/* CLOCK_MONOTONIC and nanosleep; the virtual clock is a counter that waits   */
+/* just move on, so a display driven through the simulator (see               */
+/* lcd44780simopen) runs as fast as the CPU allows while the simulator still  */
+/* sees the times the waits would have taken. One clock serves every display. */
+/*                                                                            */
+/* Waits the kernel makes itself (the SPI driver's delay after each           */
+/* instruction) can't be virtualised.                                         */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+#include "lcd44780int.h"
+
+static uint8_t clockid=LCD44780CLOCKREAL;
+static uint64_t virtualns=0;			// Virtual clock's time
+
+/* Clock internal library functions */
+
+uint64_t lcd44780clocknow(void) {
+/******************************************************************************/
+/*                                                                            */
+/* The time now in nanoseconds.                                               */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	struct timespec t;
+
+	if (clockid == LCD44780CLOCKVIRTUAL) return (virtualns);
+
+	clock_gettime(CLOCK_MONOTONIC,&t);
+	return ((uint64_t)t.tv_sec*1000000000ULL+t.tv_nsec);
+}
+
+void lcd44780clocksleep(uint64_t ns) {
+/******************************************************************************/
+/*                                                                            */
+/* Wait for ns nanoseconds, letting other processes run.                      */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	struct timespec t;
+
+	if (clockid == LCD44780CLOCKVIRTUAL) {
+		virtualns+=ns;
+		return;
+	}
+
+	t.tv_sec=ns/1000000000ULL;
+	t.tv_nsec=ns%1000000000ULL;
+	nanosleep(&t, (struct timespec *)NULL);
+	return;
+}
+
+void lcd44780clockuntil(uint64_t due) {
+/******************************************************************************/
+/*                                                                            */
+/* Wait until the time is due, spinning - for waits of a few microseconds,    */
+/* far shorter than nanosleep can manage.                                     */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	if (clockid == LCD44780CLOCKVIRTUAL) {
+		if (virtualns < due) virtualns=due;
+		return;
+	}
+
+	while (lcd44780clocknow() < due);
+	return;
+}
+
+/* Clock external library functions */
+
+int lcd44780setclock(uint8_t id)
+/******************************************************************************/
+/*                                                                            */
+/* Choose the clock the library waits by: LCD44780CLOCKREAL (the default) or  */
+/* LCD44780CLOCKVIRTUAL, where waits take no time but move the library's time */
+/* on - for driving the simulator (lcd44780simopen) faster than real time.    */
+/* Choosing the virtual clock again sets its time back to 0.                  */
+/*                                                                            */
+/* Returns 0, or BADSETTING if id isn't a clock.                              */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+{
+	if (id > LCD44780CLOCKVIRTUAL) {
+		lcd44780error_fprintf(BADSETTING);
+		return (BADSETTING);
+	}
+
+	clockid=id;
+	virtualns=0;
+	return (0);
+}
+
+uint64_t lcd44780clock(void)
+/******************************************************************************/
+/*                                                                            */
+/* The library's time in nanoseconds - CLOCK_MONOTONIC, or the virtual        */
+/* clock's time (the sum of every wait since it was chosen).                  */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+{
+	return (lcd44780clocknow());
+}
@@ -0,0 +1,74 @@
+/******************************************************************************/
+/*                                                                            */
+/* Strobe encoder benchmark for the                                           */
+/* 44780 LCD display library for I2C bus.                                     */
+/*                                                                            */
+/* Times each strobe encoder this CPU supports over a block of random         */
+/* characters, for a few backpack wirings, and checks it produces exactly the */
+/* same bytes as the scalar encoder. No display (or pigpiod) is needed.       */
+/*                                                                            */
+/* Usage: lcd44780encbench [characters] [passes]                              */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+#include "lcd44780.h"
+
+int main(int argc, char *argv[]) {
+	int len=4096, passes=2000, count, pass, enc, wiring;
+	char *src;
+	uint8_t *ref, *out;
+	struct timespec start, end;
+	double ns;
+	char *names[5]={"auto","scalar","sse2","avx2","neon"};
+	char *wirings[3]={"P4-P7 data","P0-P3 data","scrambled"};
+	lcd44780pinmap maps[3]={LCD44780PINSPCF8574, LCD44780PINSLOWDATA, {7,6,5,4,3,2,1,0,1}};
+
+	if (argc > 1) len=atoi(argv[1]);
+	if (argc > 2) passes=atoi(argv[2]);
+	if ((len < 1)||(passes < 1)) {
+		fprintf(stderr,"Usage: %s [characters] [passes]\n",argv[0]);
+		exit(1);
+	}
+
+	src=malloc(len);
+	ref=malloc(4*len);
+	out=malloc(4*len);
+	if ((src == NULL)||(ref == NULL)||(out == NULL)) {
+		fprintf(stderr,"Out of memory\n");
+		exit(1);
+	}
+
+	srand(44780);
+	for (count=0;count<len;count++) src[count]=rand();
+
+	// No display is opened - pi -1 and handle 0 just name the state used
+
+	for (wiring=0;wiring<3;wiring++) {
+		printf("%s\n",wirings[wiring]);
+		lcd44780setpins(-1,0,&maps[wiring]);
+		lcd44780setencoder(LCD44780ENCSCALAR);
+		lcd44780encode(-1,0,1,src,len,ref);
+
+		for (enc=LCD44780ENCSCALAR;enc<=LCD44780ENCNEON;enc++) {
+			if (lcd44780setencoder(enc) != enc) {
+				printf("  %-8s not supported\n",names[enc]);
+				continue;
+			}
+
+			clock_gettime(CLOCK_MONOTONIC,&start);
+			for (pass=0;pass<passes;pass++) lcd44780encode(-1,0,1,src,len,out);
+			clock_gettime(CLOCK_MONOTONIC,&end);
+
+			ns=(end.tv_sec-start.tv_sec)*1e9+(end.tv_nsec-start.tv_nsec);
+			printf("  %-8s %8.3f ns/char %s\n",names[enc],ns/((double)len*passes),
+				(memcmp(ref,out,4*len) == 0) ? "ok" : "MISMATCH");
+		}
+	}
+
+	lcd44780close(-1,0);
+	free(src);
+	free(ref);
+	free(out);
+	exit(0);
+}
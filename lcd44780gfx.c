@@ -0,0 +1,689 @@
+/******************************************************************************/
+/*                                                                            */
+/* Widgets for the HD44780U LCD display library for I2C bus - bar graphs      */
+/* drawn with partial block characters from CGRAM, big numerals and a small   */
+/* pixel canvas.                                                              */
+/*                                                                            */
+/* Widgets draw into the framebuffer and commit it, so only the cells that    */
+/* actually change are sent to the display. The user defined characters they  */
+/* need come from the glyph cache and are loaded the first time they are      */
+/* used.                                                                      */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+#include "lcd44780int.h"
+#include "lcd44780rec.h"
+
+#define FULLBLOCK       0xFF    // ROM character with every pixel set
+#define BLANK           0x20    // ROM character with no pixels set
+#define CELLWIDTH       5       // Pixels across a character cell
+#define CELLHEIGHT      8       // Pixels down a character cell
+#define BIGGLYPHS       4       // User defined characters used by big numerals
+
+/* Segment characters for big numerals, shared by both heights. Cells are     */
+/* described by letter: F full block, T top bar, B bottom bar, M top and      */
+/* bottom bars, D centre dot, space blank.                                    */
+
+static const uint8_t bigsegments[BIGGLYPHS][8]={
+	{0x1F,0x1F,0x00,0x00,0x00,0x00,0x00,0x00},	// T
+	{0x00,0x00,0x00,0x00,0x00,0x00,0x1F,0x1F},	// B
+	{0x1F,0x1F,0x00,0x00,0x00,0x00,0x1F,0x1F},	// M
+	{0x00,0x00,0x00,0x0E,0x0E,0x0E,0x00,0x00}};	// D
+
+static const char bigchars[]="0123456789 -:.";		// Characters that can be drawn
+
+static const char *big2[]={				// 2 rows, top row first
+	"FTFFBF","TF  F ","MMFFBB","MMFBBF","FBF  F","FMMBBF","FMMFBF","TTF  F",
+	"FMFFBF","FMFBBF","      ","BBB   ","DD"," D"};
+
+static const char *big4[]={				// 4 rows, top row first
+	"FTFF FF FFBF","TF  F  F BFB","TTFBBFF  FBB","TTFBBF  FBBF",
+	"F FFBF  F  F","FTTFBB  FBBF","FTTFBBF FFBF","TTF  F  F  F",
+	"FTFFBFF FFBF","FTFFBF  FBBF","            ","   BBB      ",
+	" DD ","   D"};
+
+/* Widget internal functions */
+
+static int lcd44780barglyphs(lcd44780dev *dev, uint8_t type) {
+/******************************************************************************/
+/*                                                                            */
+/* Make sure the partial block characters for a bar type are in CGRAM.        */
+/*                                                                            */
+/* LCD44780BARRIGHT needs 4 (1-4 columns lit from the left),                  */
+/* LCD44780BARUP needs 7 (1-7 rows lit from the bottom) and                   */
+/* LCD44780BARBIPOLAR needs 8 (1-4 columns lit from the left, then 1-4 lit    */
+/* from the right). Characters already loaded for another bar are shared.     */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	int i,count,level,row,nglyphs;
+	uint8_t bitmap[8];
+
+	if (dev->barglyph[type][0] >= 0) return(0);		// Already loaded
+
+	nglyphs=(type == LCD44780BARRIGHT) ? 4 : (type == LCD44780BARUP) ? 7 : 8;
+
+	for (count=0;count<nglyphs;count++) {
+		level=(count%4)+1;
+		for (row=0;row<8;row++) {
+			if (type == LCD44780BARUP) {
+				bitmap[row]=(row >= CELLHEIGHT-(count+1)) ? 0x1F : 0x00;
+			}
+			else if (count < 4) {
+				bitmap[row]=(0x1F<<(CELLWIDTH-level))&0x1F;	// Lit from the left
+			}
+			else {
+				bitmap[row]=(1<<level)-1;			// Lit from the right
+			}
+		}
+
+		i=lcd44780loadglyph(dev,bitmap);
+		if (i < 0) {
+			while (count-- > 0) dev->cgref[(int)dev->barglyph[type][count]]--;
+			dev->barglyph[type][0]=-1;
+			return(i);
+		}
+		dev->barglyph[type][count]=i;
+	}
+
+	return(0);
+}
+
+static uint8_t lcd44780barcell(lcd44780dev *dev, uint8_t type, long level, int size, int glyph) {
+/******************************************************************************/
+/*                                                                            */
+/* Character for one cell of a bar, given how many of its size pixels are     */
+/* lit. glyph is the index of the first partial block character to use.       */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	if (level <= 0) return(BLANK);
+	if (level >= size) return(FULLBLOCK);
+	return(dev->barglyph[type][glyph+level-1]);
+}
+
+static int lcd44780bigglyphs(lcd44780dev *dev) {
+/******************************************************************************/
+/*                                                                            */
+/* Make sure the segment characters for big numerals are in CGRAM.            */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	int i,count;
+
+	if (dev->bigglyph[0] >= 0) return(0);			// Already loaded
+
+	for (count=0;count<BIGGLYPHS;count++) {
+		i=lcd44780loadglyph(dev,(uint8_t *)bigsegments[count]);
+		if (i < 0) {
+			while (count-- > 0) dev->cgref[(int)dev->bigglyph[count]]--;
+			dev->bigglyph[0]=-1;
+			return(i);
+		}
+		dev->bigglyph[count]=i;
+	}
+
+	return(0);
+}
+
+static uint8_t lcd44780bigcell(lcd44780dev *dev, char segment) {
+/******************************************************************************/
+/*                                                                            */
+/* Character for one cell of a big numeral, from its segment letter.          */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	switch (segment) {
+		case 'F': return(FULLBLOCK);
+		case 'T': return(dev->bigglyph[0]);
+		case 'B': return(dev->bigglyph[1]);
+		case 'M': return(dev->bigglyph[2]);
+		case 'D': return(dev->bigglyph[3]);
+	}
+	return(BLANK);
+}
+
+static lcd44780canvas *lcd44780getcanvas(int pi, int fd, lcd44780dev **devp) {
+/******************************************************************************/
+/*                                                                            */
+/* Find the canvas set up on a display, reporting an error if there is none.  */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	lcd44780dev *dev;
+
+	dev=lcd44780getdev(pi,fd,0);
+	if ((dev == NULL) || (dev->canvas == NULL)) {
+		lcd44780error_fprintf(BADWIDGET);
+		return(NULL);
+	}
+
+	*devp=dev;
+	return(dev->canvas);
+}
+
+static void lcd44780tilebitmap(lcd44780canvas *cv, int tile, uint8_t *bitmap) {
+/******************************************************************************/
+/*                                                                            */
+/* Cut the 5x8 pixel bitmap for one cell out of the canvas bit plane.         */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	int row,x;
+	uint16_t bits;
+	uint8_t *line;
+
+	x=(tile%cv->width)*CELLWIDTH;
+	for (row=0;row<CELLHEIGHT;row++) {
+		line=cv->plane[(tile/cv->width)*CELLHEIGHT+row];
+		bits=(line[x/8]<<8)|line[x/8+1];		// Plane is padded, so x/8+1 is safe
+		bitmap[row]=(bits>>(16-CELLWIDTH-(x%8)))&0x1F;
+	}
+	return;
+}
+
+static int lcd44780tileupload(lcd44780dev *dev, int slot, uint8_t *bitmap) {
+/******************************************************************************/
+/*                                                                            */
+/* Bring a CGRAM slot up to date with bitmap, sending only the rows that      */
+/* differ from what the slot already holds.                                   */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	int i=0,row,rows=0;
+
+	if ((dev->cgvalid & (1<<slot)) == 0) {
+		return(lcd44780defchar(dev->pi,dev->fd,slot,bitmap));
+	}
+
+	for (row=0;row<CELLHEIGHT;row++) {
+		if (dev->cgram[slot][row] == bitmap[row]) continue;
+		if (dev->ac != (CGRAMAC|(slot<<3)|row)) {
+			i=lcd44780writecmd4(dev->pi,dev->fd,CGRAMSETADDR|(slot<<3)|row);
+		}
+		else COUNT(dev,addrskipped,1);
+		i=lcd44780writedata(dev->pi,dev->fd,bitmap[row]);
+		rows++;
+	}
+	PROBE4(glyph,dev->pi,dev->fd,slot,rows);
+
+	return(i);
+}
+
+/* Widget external library functions */
+
+int lcd44780bar(int pi, int fd, uint8_t type, uint8_t row, uint8_t col, uint8_t len, int value, int max)
+/******************************************************************************/
+/*                                                                            */
+/* Draw a bar graph of value out of max, len cells long, with its top left    */
+/* cell at row, col.                                                          */
+/*                                                                            */
+/* LCD44780BARRIGHT - horizontal bar growing to the right, 5 steps per cell.  */
+/* LCD44780BARUP - vertical bar on rows row to row+len-1 growing upwards from */
+/*                 the bottom, 8 steps per cell.                              */
+/* LCD44780BARBIPOLAR - horizontal bar for values from -max to max, growing   */
+/*                 left or right from the boundary after the first len/2      */
+/*                 cells, 5 steps per cell. len must be at least 2.           */
+/*                                                                            */
+/* Only cells whose level changes are sent, so a bar that moves by a step     */
+/* costs a single data write (two when a bipolar bar crosses zero), plus a    */
+/* set address command.                                                       */
+/*                                                                            */
+/* Prerequisite - lcd44780init must have been successfully called first.      */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+{
+	int i,count,half,end,args[6];
+	long pixels;
+	lcd44780dev *dev;
+
+	dev=lcd44780getdev(pi,fd,1);
+	if (dev == NULL) {
+		lcd44780error_fprintf(NOMEMORY);
+		return (NOMEMORY);
+	}
+
+	if ((type > LCD44780BARBIPOLAR) || (len == 0) || (max <= 0) ||
+	    ((type == LCD44780BARBIPOLAR) && (len < 2))) {
+		lcd44780error_fprintf(BADWIDGET);
+		return (BADWIDGET);
+	}
+
+	/* Check both ends of the bar are on the display (the far end as an int) */
+
+	i=lcd44780checkpos(dev,row,col);
+	if (i != 0) return (i);
+	if (type == LCD44780BARUP) {
+		end=(int)row+len-1;
+		if (end > ORIGIN+dev->rows-1) i=ROWTOOHIGH;
+	}
+	else {
+		end=(int)col+len-1;
+		if (end > ORIGIN+dev->cols-1) i=COLTOOHIGH;
+	}
+	if (i != 0) {
+		lcd44780error_fprintf(i);
+		return (i);
+	}
+
+	args[0]=type;
+	args[1]=row;
+	args[2]=col;
+	args[3]=len;
+	args[4]=value;
+	args[5]=max;
+	lcd44780reccall(dev,RECBAR,6,args,NULL,0);
+
+	i=lcd44780barglyphs(dev,type);
+	if (i < 0) {
+		lcd44780recend(dev,i);
+		lcd44780error_fprintf(i);
+		return (i);
+	}
+
+	/* Work out the level of each cell in the framebuffer */
+
+	row-=ORIGIN;
+	col-=ORIGIN;
+
+	if (value > max) value=max;
+
+	if (type == LCD44780BARRIGHT) {
+		if (value < 0) value=0;
+		pixels=((long)value*len*CELLWIDTH+max/2)/max;
+		for (count=0;count<len;count++) {
+			dev->fb[lcd44780ddaddr(row,col+count)]=
+				lcd44780barcell(dev,type,pixels-count*CELLWIDTH,CELLWIDTH,0);
+		}
+	}
+	else if (type == LCD44780BARUP) {
+		if (value < 0) value=0;
+		pixels=((long)value*len*CELLHEIGHT+max/2)/max;
+		for (count=0;count<len;count++) {
+			dev->fb[lcd44780ddaddr(row+len-1-count,col)]=
+				lcd44780barcell(dev,type,pixels-count*CELLHEIGHT,CELLHEIGHT,0);
+		}
+	}
+	else {
+		if (value < -max) value=-max;
+		half=len/2;
+		pixels=((long)value*half*CELLWIDTH+((value < 0) ? -max/2 : max/2))/max;
+		for (count=0;count<len-half;count++) {		// Right of the centre
+			dev->fb[lcd44780ddaddr(row,col+half+count)]=
+				lcd44780barcell(dev,type,pixels-count*CELLWIDTH,CELLWIDTH,0);
+		}
+		for (count=0;count<half;count++) {		// Left of the centre
+			dev->fb[lcd44780ddaddr(row,col+half-1-count)]=
+				lcd44780barcell(dev,type,-pixels-count*CELLWIDTH,CELLWIDTH,4);
+		}
+	}
+
+	i=lcd44780commitdev(dev);
+	lcd44780recend(dev,i);
+	return (i);
+}
+
+int lcd44780bignum(int pi, int fd, char *writebuf, uint8_t row, uint8_t col, uint8_t height)
+/******************************************************************************/
+/*                                                                            */
+/* Write a string in big numerals, height (2 or 4) rows tall, with its top    */
+/* left cell at row, col. Digits are 3 cells wide; '.' and ':' are 1 cell     */
+/* wide; ' ' and '-' are 3 cells wide. Characters are separated by a blank    */
+/* column, and any other character is drawn as a space. The string is cut     */
+/* short at the last character that fits on the row.                          */
+/*                                                                            */
+/* The numerals are built from 4 user defined characters, loaded the first    */
+/* time they are needed. Only cells that differ from what's on the display    */
+/* are sent, so a clock ticking over once a second usually only rewrites the  */
+/* cells of its last digit.                                                   */
+/*                                                                            */
+/* Prerequisite - lcd44780init must have been successfully called first.      */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+{
+	int i,count,line,width,x,args[3];
+	const char *cells,*found;
+	lcd44780dev *dev;
+
+	dev=lcd44780getdev(pi,fd,1);
+	if (dev == NULL) {
+		lcd44780error_fprintf(NOMEMORY);
+		return (NOMEMORY);
+	}
+
+	if ((height != 2) && (height != 4)) {
+		lcd44780error_fprintf(BADWIDGET);
+		return (BADWIDGET);
+	}
+
+	i=lcd44780checkpos(dev,row,col);
+	if (i != 0) return (i);
+	i=lcd44780checkpos(dev,row+height-1,col);
+	if (i != 0) return (i);
+
+	args[0]=row;
+	args[1]=col;
+	args[2]=height;
+	lcd44780reccall(dev,RECBIGNUM,3,args,writebuf,RECSTRING);
+
+	i=lcd44780bigglyphs(dev);
+	if (i < 0) {
+		lcd44780recend(dev,i);
+		lcd44780error_fprintf(i);
+		return (i);
+	}
+
+	row-=ORIGIN;
+	x=col-ORIGIN;
+
+	for (count=0;writebuf[count] != '\0';count++) {
+		found=strchr(bigchars,writebuf[count]);
+		if (found == NULL) found=strchr(bigchars,' ');
+		cells=(height == 2) ? big2[found-bigchars] : big4[found-bigchars];
+		width=strlen(cells)/height;
+
+		if (count > 0) {				// Gap between characters
+			if (x+1+width > dev->cols) break;
+			for (line=0;line<height;line++) {
+				dev->fb[lcd44780ddaddr(row+line,x)]=BLANK;
+			}
+			x++;
+		}
+		else if (x+width > dev->cols) break;
+
+		for (line=0;line<height;line++) {
+			for (i=0;i<width;i++) {
+				dev->fb[lcd44780ddaddr(row+line,x+i)]=lcd44780bigcell(dev,cells[line*width+i]);
+			}
+		}
+		x+=width;
+	}
+
+	i=lcd44780commitdev(dev);
+	lcd44780recend(dev,i);
+	return (i);
+}
+
+int lcd44780canvasinit(int pi, int fd, uint8_t row, uint8_t col, uint8_t width, uint8_t height)
+/******************************************************************************/
+/*                                                                            */
+/* Set up a blank pixel canvas width cells across and height cells down, with */
+/* its top left cell at row, col - e.g. 4x2 cells give 20x16 pixels. A        */
+/* display has one canvas; calling this again replaces it.                    */
+/*                                                                            */
+/* Draw with lcd44780plot, lcd44780canvasscroll and lcd44780canvasclear, then */
+/* make the drawing visible with lcd44780canvascommit.                        */
+/*                                                                            */
+/* Prerequisite - lcd44780init must have been successfully called first.      */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+{
+	int i,count,args[4];
+	lcd44780dev *dev;
+
+	dev=lcd44780getdev(pi,fd,1);
+	if (dev == NULL) {
+		lcd44780error_fprintf(NOMEMORY);
+		return (NOMEMORY);
+	}
+
+	if ((width == 0) || (height == 0) || (width > CANVASMAXW) || (height > CANVASMAXH)) {
+		lcd44780error_fprintf(BADWIDGET);
+		return (BADWIDGET);
+	}
+
+	i=lcd44780checkpos(dev,row,col);
+	if (i != 0) return (i);
+	i=lcd44780checkpos(dev,row+height-1,col+width-1);
+	if (i != 0) return (i);
+
+	if (dev->canvas == NULL) {
+		dev->canvas=calloc(1,sizeof(lcd44780canvas));
+		if (dev->canvas == NULL) {
+			lcd44780error_fprintf(NOMEMORY);
+			return (NOMEMORY);
+		}
+	}
+	else {						// Give back the old canvas's slots
+		for (count=0;count<CANVASMAXH*CANVASMAXW;count++) {
+			if (dev->canvas->slot[count] >= 0) dev->cgref[(int)dev->canvas->slot[count]]=0;
+		}
+	}
+
+	dev->canvas->row=row-ORIGIN;
+	dev->canvas->col=col-ORIGIN;
+	dev->canvas->width=width;
+	dev->canvas->height=height;
+	memset(dev->canvas->plane,0,sizeof(dev->canvas->plane));
+	memset(dev->canvas->dirty,1,sizeof(dev->canvas->dirty));
+	memset(dev->canvas->slot,-1,sizeof(dev->canvas->slot));
+
+	args[0]=row;
+	args[1]=col;
+	args[2]=width;
+	args[3]=height;
+	lcd44780reccall(dev,RECCANVASINIT,4,args,NULL,0);
+	lcd44780recend(dev,0);
+
+	return (0);
+}
+
+int lcd44780plot(int pi, int fd, int x, int y, uint8_t setting)
+/******************************************************************************/
+/*                                                                            */
+/* Set (setting non zero) or clear the canvas pixel at x, y. 0, 0 is the top  */
+/* left pixel. Pixels off the canvas are ignored, so lines and plots can run  */
+/* off the edge.                                                              */
+/*                                                                            */
+/* Prerequisite - lcd44780canvasinit must have been successfully called.      */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+{
+	int args[3];
+	uint8_t mask,*byte;
+	lcd44780dev *dev;
+	lcd44780canvas *cv;
+
+	cv=lcd44780getcanvas(pi,fd,&dev);
+	if (cv == NULL) return (BADWIDGET);
+
+	if ((x < 0) || (y < 0) || (x >= cv->width*CELLWIDTH) || (y >= cv->height*CELLHEIGHT)) return (0);
+
+	byte=&cv->plane[y][x/8];
+	mask=0x80>>(x%8);
+	if (((*byte & mask) != 0) == (setting != 0)) return (0);
+
+	args[0]=x;
+	args[1]=y;
+	args[2]=setting;
+	lcd44780reccall(dev,RECPLOT,3,args,NULL,0);	// Only plots that change the canvas
+	*byte^=mask;
+	cv->dirty[(y/CELLHEIGHT)*cv->width+(x/CELLWIDTH)]=1;
+	lcd44780recend(dev,0);
+
+	return (0);
+}
+
+int lcd44780canvasclear(int pi, int fd)
+/******************************************************************************/
+/*                                                                            */
+/* Clear every pixel on the canvas.                                           */
+/*                                                                            */
+/* Prerequisite - lcd44780canvasinit must have been successfully called.      */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+{
+	lcd44780dev *dev;
+	lcd44780canvas *cv;
+
+	cv=lcd44780getcanvas(pi,fd,&dev);
+	if (cv == NULL) return (BADWIDGET);
+
+	lcd44780reccall(dev,RECCANVASCLEAR,0,NULL,NULL,0);
+	memset(cv->plane,0,sizeof(cv->plane));
+	memset(cv->dirty,1,sizeof(cv->dirty));
+	lcd44780recend(dev,0);
+
+	return (0);
+}
+
+int lcd44780canvasscroll(int pi, int fd, uint8_t pixels)
+/******************************************************************************/
+/*                                                                            */
+/* Move the canvas contents left by a number of pixels, clearing the columns  */
+/* uncovered on the right - ready for the next point of a trend line.         */
+/*                                                                            */
+/* Prerequisite - lcd44780canvasinit must have been successfully called.      */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+{
+	int y,b,count,bytes,width,args[1];
+	uint8_t *line;
+	lcd44780dev *dev;
+	lcd44780canvas *cv;
+
+	cv=lcd44780getcanvas(pi,fd,&dev);
+	if (cv == NULL) return (BADWIDGET);
+
+	args[0]=pixels;
+	lcd44780reccall(dev,RECCANVASSCROLL,1,args,NULL,0);
+	width=cv->width*CELLWIDTH;
+	bytes=(width+7)/8;
+
+	for (y=0;y<cv->height*CELLHEIGHT;y++) {
+		line=cv->plane[y];
+		for (count=0;count<pixels;count++) {		// Whole line, a bit at a time
+			for (b=0;b<bytes;b++) {
+				line[b]=(line[b]<<1)|((b+1 < bytes) ? (line[b+1]>>7) : 0);
+			}
+		}
+		if (width%8) line[bytes-1]&=0xFF<<(8-(width%8)); // Nothing beyond the edge
+	}
+	memset(cv->dirty,1,sizeof(cv->dirty));
+	lcd44780recend(dev,0);
+
+	return (0);
+}
+
+int lcd44780canvascommit(int pi, int fd)
+/******************************************************************************/
+/*                                                                            */
+/* Make the canvas drawing visible. Only cells drawn on since the last commit */
+/* are looked at. A cell with no pixels set is shown as a space and one with  */
+/* every pixel set as the ROM full block, so neither uses a CGRAM slot. Other */
+/* cells get a slot of their own, and only rows that differ from what the     */
+/* slot already holds are sent - scrolling a trend line a pixel costs just    */
+/* the rows the line passes through.                                          */
+/*                                                                            */
+/* With more than 8 partly lit cells, the extra cells are shown as a space or */
+/* full block, whichever is closer, and NOGLYPHSLOT is returned.              */
+/*                                                                            */
+/* Any other framebuffer changes waiting to be committed are sent too.        */
+/*                                                                            */
+/* Prerequisite - lcd44780canvasinit must have been successfully called.      */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+{
+	int i,tile,tiles,row,lit,slot,missing=0;
+	uint8_t bitmap[CANVASMAXH*CANVASMAXW][8],kind[CANVASMAXH*CANVASMAXW];
+	uint8_t addr;
+	lcd44780dev *dev;
+	lcd44780canvas *cv;
+
+	cv=lcd44780getcanvas(pi,fd,&dev);
+	if (cv == NULL) return (BADWIDGET);
+
+	lcd44780reccall(dev,RECCANVASCOMMIT,0,NULL,NULL,0);
+	tiles=cv->width*cv->height;
+	lcd44780hold(dev);				// Whole commit goes as one frame
+
+	/* First show cells that no longer need their slot as ROM characters, so */
+	/* the slot can be handed to another cell without it flickering.         */
+
+	for (tile=0;tile<tiles;tile++) {
+		kind[tile]=0;
+		if (cv->dirty[tile] == 0) continue;
+		lcd44780tilebitmap(cv,tile,bitmap[tile]);
+		for (row=0,lit=0;row<CELLHEIGHT;row++) lit+=__builtin_popcount(bitmap[tile][row]);
+		if ((lit != 0) && (lit != CELLWIDTH*CELLHEIGHT)) {
+			kind[tile]=1;				// Needs a slot
+			continue;
+		}
+		addr=lcd44780ddaddr(cv->row+(tile/cv->width),cv->col+(tile%cv->width));
+		dev->fb[addr]=(lit == 0) ? BLANK : FULLBLOCK;
+		if (cv->slot[tile] >= 0) {
+			dev->cgref[(int)cv->slot[tile]]=0;
+			cv->slot[tile]=-1;
+		}
+		cv->dirty[tile]=0;
+	}
+	i=lcd44780commitdev(dev);
+
+	/* Then bring the slots up to date and point the cells at them */
+
+	for (tile=0;tile<tiles;tile++) {
+		if (kind[tile] == 0) continue;
+		addr=lcd44780ddaddr(cv->row+(tile/cv->width),cv->col+(tile%cv->width));
+		slot=cv->slot[tile];
+		if (slot < 0) {
+			slot=lcd44780freeslot(dev);
+			if (slot < 0) {				// Out of slots - nearest ROM character
+				for (row=0,lit=0;row<CELLHEIGHT;row++) lit+=__builtin_popcount(bitmap[tile][row]);
+				dev->fb[addr]=(lit*2 < CELLWIDTH*CELLHEIGHT) ? BLANK : FULLBLOCK;
+				missing++;
+				continue;			// Stays dirty, to retry next commit
+			}
+			dev->cgref[slot]=GLYPHPINNED;
+			cv->slot[tile]=slot;
+		}
+		i=lcd44780tileupload(dev,slot,bitmap[tile]);
+		dev->fb[addr]=slot;
+		cv->dirty[tile]=0;
+	}
+	lcd44780commitdev(dev);
+	i=lcd44780release(dev);
+
+	if (missing != 0) {
+		lcd44780error_fprintf(NOGLYPHSLOT);
+		i=NOGLYPHSLOT;
+	}
+	lcd44780recend(dev,i);
+
+	return (i);
+}
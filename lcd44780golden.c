@@ -0,0 +1,283 @@
+/******************************************************************************/
+/*                                                                            */
+/* Golden byte stream check for the                                           */
+/* 44780 LCD display library for I2C bus.                                     */
+/*                                                                            */
+/* Runs a fixed set of operations (lcd44780init, str, chr, clearline, clear,  */
+/* home, backlight, setdisplay and defchar) on mock displays (lcd44780spimock */
+/* and lcd44780gpiomock) for a few backpack wirings, and compares every byte  */
+/* each one sends with those in the golden file, once for each strobe encoder */
+/* this CPU supports. Any difference fails the check - if a change to the     */
+/* bytes is meant (and has been tried on a real display), update the file     */
+/* with -u and check in the new one with the change. No display (or pigpiod)  */
+/* is needed.                                                                 */
+/*                                                                            */
+/* The mocks record more than the bytes. An SPI one records each transfer     */
+/* as it would be handed to spidev, pauses included, and a GPIO one records   */
+/* each setting of the lines and the time since the last - so the pacing of   */
+/* the display is pinned down as well as what is sent to it.                  */
+/*                                                                            */
+/* The bytes the spi-pcf8574 wiring sends (the first of each record) for the  */
+/* operations the library started with - all but the UTF-8 ones, defchar and  */
+/* close - are those it sent then.                                            */
+/*                                                                            */
+/* Usage: lcd44780golden [-u] [file]                                          */
+/*                                                                            */
+/*      -u  write the bytes sent now (by the scalar encoder) to the file      */
+/*      file defaults to lcd44780golden.txt                                   */
+/*                                                                            */
+/* Returns 0 if every encoder's bytes match the file, 1 if not.               */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+#include "lcd44780.h"
+
+#define GOLDENFILE              "lcd44780golden.txt"
+#define GOLDENPERLINE           16      // Bytes on each line of the file, unless they're records
+#define GOLDENSPI               0       // Mock each wiring is run on
+#define GOLDENGPIO              1
+
+typedef struct {
+	char *name;
+	int mock;				// GOLDENSPI (lcd44780spimock) or GOLDENGPIO (lcd44780gpiomock)
+	int bits;				// 4 or 8 (lcd44780gpiomock only)
+	lcd44780pinmap pins;			// Wiring, for 4 bit mode
+	int record;				// Bytes the mock writes at a time, each on its own line, or 0
+} goldenwiring;
+
+static const goldenwiring wirings[]={
+	{"spi-pcf8574",GOLDENSPI,4,LCD44780PINSPCF8574,10},
+	{"spi-lowdata",GOLDENSPI,4,LCD44780PINSLOWDATA,10},
+	{"spi-scrambled",GOLDENSPI,4,{7,6,5,4,3,2,1,0,1},10},	// Strobe table only, backlight active low
+	{"gpio-4bit",GOLDENGPIO,4,{7,6,5,4,3,2,1,0,1},6},	// Lines still in order, backlight active low
+	{"gpio-8bit",GOLDENGPIO,8,LCD44780PINSMCP23017,6},
+};
+#define GOLDENWIRINGS           (sizeof(wirings)/sizeof(wirings[0]))
+
+static void goldenop(FILE *out, int tf, off_t *from, int record, char *op) {
+/******************************************************************************/
+/*                                                                            */
+/* Write op and the bytes sent since the last one to out, in hex - a record   */
+/* to a line if the mock writes record bytes at a time.                       */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	int perline;
+	off_t to,at;
+	uint8_t byte;
+
+	perline=(record > 0) ? record : GOLDENPERLINE;
+	to=lseek(tf,0,SEEK_CUR);
+	fprintf(out,"%s (%lld bytes)\n",op,(long long)(to-*from));
+	for (at=*from;at<to;at++) {
+		if (pread(tf,&byte,1,at) != 1) byte=0;
+		fprintf(out,"%s%02X",((at-*from)%perline == 0) ? "\t" : " ",byte);
+		if (((at-*from)%perline == perline-1) || (at == to-1)) fprintf(out,"\n");
+	}
+	*from=to;
+	return;
+}
+
+static int goldenrun(FILE *out, const goldenwiring *w) {
+/******************************************************************************/
+/*                                                                            */
+/* Run the operations on a mock display wired as w, writing what each sent    */
+/* to out. Returns 0, or -1 if the mock can't be opened.                      */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	int pi=LCD44780NOPI, fd, tf;
+	uint8_t glyph[8]={0x0E,0x11,0x11,0x1F,0x1B,0x1B,0x1F,0x00};
+	off_t from=0;
+	FILE *t;
+	lcd44780pinmap pins;
+
+	t=tmpfile();
+	if (t == NULL) return (-1);
+	tf=fileno(t);
+
+	fd=(w->mock == GOLDENGPIO) ? lcd44780gpiomock(tf,w->bits) : lcd44780spimock(tf);
+	if (fd < 0) {
+		fclose(t);
+		return (-1);
+	}
+	if (w->bits == 4) {
+		pins=w->pins;
+		lcd44780setpins(pi,fd,&pins);
+	}
+
+	fprintf(out,"[%s]\n",w->name);
+
+	lcd44780init(pi,fd,4,20);
+	goldenop(out,tf,&from,w->record,"init 4 20");
+	lcd44780str(pi,fd,"Hello World!",1,5);
+	goldenop(out,tf,&from,w->record,"str \"Hello World!\" 1 5");
+	lcd44780str(pi,fd,"ABCDEFGHIJKLMNOPQRSTUVWXYZ",2,1);
+	goldenop(out,tf,&from,w->record,"str \"ABCDEFGHIJKLMNOPQRSTUVWXYZ\" 2 1");
+	lcd44780str(pi,fd,"\xC2\xA3" "5 \xC2\xB0" "C",3,15);
+	goldenop(out,tf,&from,w->record,"str \"\\xC2\\xA35 \\xC2\\xB0C\" 3 15");
+	lcd44780chr(pi,fd,"A",4,1);
+	goldenop(out,tf,&from,w->record,"chr \"A\" 4 1");
+	lcd44780chr(pi,fd,"~",4,2);
+	goldenop(out,tf,&from,w->record,"chr \"~\" 4 2");
+	lcd44780chr(pi,fd,"\xC3\xA9",4,20);
+	goldenop(out,tf,&from,w->record,"chr \"\\xC3\\xA9\" 4 20");
+	lcd44780clearline(pi,fd,2,10);
+	goldenop(out,tf,&from,w->record,"clearline 2 10");
+	lcd44780clearline(pi,fd,1,1);
+	goldenop(out,tf,&from,w->record,"clearline 1 1");
+	lcd44780backlight(pi,fd,0);
+	goldenop(out,tf,&from,w->record,"backlight 0");
+	lcd44780str(pi,fd,"dark",1,1);
+	goldenop(out,tf,&from,w->record,"str \"dark\" 1 1");
+	lcd44780backlight(pi,fd,1);
+	goldenop(out,tf,&from,w->record,"backlight 1");
+	lcd44780setdisplay(pi,fd,1,1,1);
+	goldenop(out,tf,&from,w->record,"setdisplay 1 1 1");
+	lcd44780setdisplay(pi,fd,1,0,0);
+	goldenop(out,tf,&from,w->record,"setdisplay 1 0 0");
+	lcd44780setdisplay(pi,fd,0,0,0);
+	goldenop(out,tf,&from,w->record,"setdisplay 0 0 0");
+	lcd44780home(pi,fd);
+	goldenop(out,tf,&from,w->record,"home");
+	lcd44780clear(pi,fd);
+	goldenop(out,tf,&from,w->record,"clear");
+	lcd44780str(pi,fd,"after clear",1,1);
+	goldenop(out,tf,&from,w->record,"str \"after clear\" 1 1");
+	lcd44780defchar(pi,fd,1,glyph);
+	goldenop(out,tf,&from,w->record,"defchar 1 0E 11 11 1F 1B 1B 1F 00");
+
+	lcd44780close(pi,fd);
+	goldenop(out,tf,&from,w->record,"close");
+	fclose(t);
+	return (0);
+}
+
+static char *goldenall(size_t *len) {
+/******************************************************************************/
+/*                                                                            */
+/* Run every wiring with the encoder in use. Returns the text (free it after  */
+/* use) and its length, or NULL.                                              */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	unsigned w;
+	int i=0;
+	char *text=NULL;
+	FILE *out;
+
+	out=open_memstream(&text,len);
+	if (out == NULL) return (NULL);
+
+	fprintf(out,"# Bytes sent by each operation - written by lcd44780golden -u\n");
+	for (w=0;(w<GOLDENWIRINGS)&&(i==0);w++) i=goldenrun(out,&wirings[w]);
+	fclose(out);
+
+	if (i < 0) {
+		free(text);
+		return (NULL);
+	}
+	return (text);
+}
+
+static int goldendiff(char *want, char *got) {
+/******************************************************************************/
+/*                                                                            */
+/* Print the first line that differs between want and got. Returns 0 if       */
+/* there is none, 1 if there is.                                              */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	int line=1, oplen=0;
+	size_t wl,gl;
+	char *op="";
+
+	while ((*want != '\0') || (*got != '\0')) {
+		wl=strcspn(want,"\n");
+		gl=strcspn(got,"\n");
+		if (*want != '\t') {			// Operation the bytes below belong to
+			op=want;
+			oplen=wl;
+		}
+		if ((wl != gl) || (strncmp(want,got,wl) != 0)) {
+			printf("DIFFERS at line %d, %.*s\n    golden: %.*s\n    now:    %.*s\n",line,oplen,
+				op,(int)wl,want,(int)gl,got);
+			return (1);
+		}
+		want+=wl+(want[wl] == '\n');
+		got+=gl+(got[gl] == '\n');
+		line++;
+	}
+	return (0);
+}
+
+int main(int argc, char *argv[]) {
+	int opt, update=0, failed=0, enc;
+	char *file=GOLDENFILE, *golden, *now;
+	char *names[5]={"auto","scalar","sse2","avx2","neon"};
+	size_t len;
+	long size;
+	FILE *f;
+
+	while ((opt=getopt(argc,argv,"u")) != -1) {
+		if (opt == 'u') update=1;
+		else {
+			fprintf(stderr,"Usage: %s [-u] [file]\n",argv[0]);
+			exit(1);
+		}
+	}
+	if (optind < argc) file=argv[optind];
+
+	lcd44780setclock(LCD44780CLOCKVIRTUAL);	// The waits don't change the bytes
+
+	if (update) {
+		lcd44780setencoder(LCD44780ENCSCALAR);
+		now=goldenall(&len);
+		f=fopen(file,"w");
+		if ((now == NULL) || (f == NULL) || (fwrite(now,1,len,f) != len) || (fclose(f) != 0)) {
+			fprintf(stderr,"Can't write %s\n",file);
+			exit(1);
+		}
+		printf("Wrote %s\n",file);
+		free(now);
+		exit(0);
+	}
+
+	f=fopen(file,"r");
+	if (f == NULL) {
+		fprintf(stderr,"Can't read %s - make it with %s -u\n",file,argv[0]);
+		exit(1);
+	}
+	fseek(f,0,SEEK_END);
+	size=ftell(f);
+	rewind(f);
+	golden=malloc(size+1);
+	if ((golden == NULL) || (fread(golden,1,size,f) != (size_t)size)) {
+		fprintf(stderr,"Can't read %s\n",file);
+		exit(1);
+	}
+	golden[size]='\0';
+	fclose(f);
+
+	for (enc=LCD44780ENCSCALAR;enc<=LCD44780ENCNEON;enc++) {
+		if (lcd44780setencoder(enc) != enc) continue;	// Can't run here
+
+		now=goldenall(&len);
+		if (now == NULL) {
+			fprintf(stderr,"Can't open a mock display\n");
+			exit(1);
+		}
+		printf("%-7s ",names[enc]);
+		if (goldendiff(golden,now) == 0) printf("matches %s\n",file);
+		else failed=1;
+		free(now);
+	}
+
+	lcd44780setencoder(LCD44780ENCAUTO);
+	exit(failed);
+}
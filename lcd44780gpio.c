@@ -0,0 +1,353 @@
+/******************************************************************************/
+/*                                                                            */
+/* Direct GPIO driver for the HD44780U LCD display library, for displays      */
+/* wired straight to the Raspberry Pi's GPIO pins, using the Linux GPIO       */
+/* character device (v2 uAPI) - no pigpiod needed.                            */
+/*                                                                            */
+/* The bytes queued are those for a PCF8574 (4 bit mode) or the data/control  */
+/* pairs of an 8 bit MCP23017, each turned into one GPIO_V2_LINE_SET_VALUES   */
+/* call setting every line at once. Without a slow bus in the way, the        */
+/* HD44780U's timings are kept to directly: address set up before enable      */
+/* rises, enable pulse width, and the execution time of each instruction.     */
+/*                                                                            */
+/* R/W must be tied low. The lines used are the ones passed to                */
+/* lcd44780gpioopen - lcd44780setpins can't move them, but a map with         */
+/* blinvert set lights the backlight by driving its line low.                 */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+#include "lcd44780int.h"
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <linux/gpio.h>
+
+// HD44780U timings (datasheet minimums, nanoseconds)
+
+#define PWEHNS                  450     // Enable pulse width, high
+#define TCYCENS                 1000    // Enable cycle time
+
+// Lines are requested in this order: RS, E, the data lines, then the backlight
+
+#define LINERS                  0x01
+#define LINEE                   0x02
+#define LINEDATA                2
+
+#define GPIORECORD              6       // Mock - bytes recorded each time the lines are set
+
+/* GPIO driver internal library functions */
+
+static void lcd44780gpiowait(lcd44780dev *dev) {
+/******************************************************************************/
+/*                                                                            */
+/* Wait until the lines may change again. The waits are a few microseconds    */
+/* at most, far shorter than nanosleep can manage, so spin.                   */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	lcd44780clockuntil(dev->due);
+	return;
+}
+
+static void lcd44780gpiodue(lcd44780dev *dev, long ns) {
+/******************************************************************************/
+/*                                                                            */
+/* The lines may next change ns nanoseconds from now.                         */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	dev->due=lcd44780clocknow()+ns;
+	return;
+}
+
+static int lcd44780gpiolines(lcd44780dev *dev, struct gpio_v2_line_values *values) {
+/******************************************************************************/
+/*                                                                            */
+/* Set the lines to values. A mock display records them in its file instead,  */
+/* with the nanoseconds since they were last set.                             */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	int count;
+	uint8_t record[GPIORECORD];
+	uint64_t now,gap;
+
+	if (dev->mock == 0) return(ioctl(dev->fd,GPIO_V2_LINE_SET_VALUES_IOCTL,values));
+
+	now=lcd44780clocknow();
+	gap=now-dev->setat;
+	if (gap > UINT32_MAX) gap=UINT32_MAX;
+	dev->setat=now;
+
+	for (count=0;count<4;count++) record[count]=(gap>>(count*8))&0xFF;	// Little endian
+	record[4]=values->bits&0xFF;
+	record[5]=(values->bits>>8)&0xFF;
+
+	return((write(dev->fd,record,GPIORECORD) == GPIORECORD) ? 0 : -1);
+}
+
+static int lcd44780gpioset(lcd44780dev *dev, uint64_t lines) {
+/******************************************************************************/
+/*                                                                            */
+/* Set every line at once, pacing enable: data and RS go out before enable    */
+/* rises, enable stays high for PWEHNS, and falling enable latches the        */
+/* nibble or byte - the end of an instruction (every fall in 8 bit mode,      */
+/* every second in 4 bit mode) is followed by its execution time.             */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	int i=0;
+	struct gpio_v2_line_values values;
+
+	values.mask=(dev->nlines == 64) ? ~0ULL : (1ULL<<dev->nlines)-1;
+
+	if ((lines & LINEE) && ((dev->lines & LINEE) == 0) && ((lines^dev->lines) & ~(uint64_t)LINEE)) {
+		lcd44780gpiowait(dev);				// Address set up first
+		values.bits=lines & ~(uint64_t)LINEE;
+		i=lcd44780gpiolines(dev,&values);
+		dev->lines=values.bits;
+	}
+
+	lcd44780gpiowait(dev);
+	values.bits=lines;
+	if (i >= 0) i=lcd44780gpiolines(dev,&values);
+
+	if ((lines & LINEE) && ((dev->lines & LINEE) == 0)) {
+		lcd44780gpiodue(dev,PWEHNS);
+	}
+	else if (((lines & LINEE) == 0) && (dev->lines & LINEE)) {
+		if ((dev->drv->eightbit) || (++dev->phase == 2)) {
+			lcd44780gpiodue(dev,EXECNS);
+			dev->phase=0;
+		}
+		else lcd44780gpiodue(dev,TCYCENS-PWEHNS);
+	}
+	dev->lines=lines;
+
+	return(i);
+}
+
+static void lcd44780gpionibble(lcd44780dev *dev, uint8_t data) {
+/******************************************************************************/
+/*                                                                            */
+/* An 8 bit mode instruction is a single enable pulse (4 bit mode wiring).    */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	lcd44780flush(dev);
+	dev->phase=1;
+	lcd44780pcfnibble(dev,data);
+	return;
+}
+
+static int lcd44780gpio4send(lcd44780dev *dev, uint8_t *buf, int len) {
+/******************************************************************************/
+/*                                                                            */
+/* Each queued byte, laid out as for a PCF8574 wired as the display's pin     */
+/* map says, sets the lines once.                                             */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	int i=0,count;
+	uint8_t b;
+	uint64_t lines;
+
+	for (count=0;(count<len)&&(i>=0);count++) {
+		b=buf[count];
+		lines=((b & dev->rsbit) ? LINERS : 0)|
+		      ((b & dev->enbit) ? LINEE : 0)|
+		      ((uint64_t)((b>>dev->pins.d4)&1)<<LINEDATA)|
+		      ((uint64_t)((b>>dev->pins.d5)&1)<<(LINEDATA+1))|
+		      ((uint64_t)((b>>dev->pins.d6)&1)<<(LINEDATA+2))|
+		      ((uint64_t)((b>>dev->pins.d7)&1)<<(LINEDATA+3));
+		if ((b & dev->blbit) && (dev->nlines > LINEDATA+4)) lines|=1ULL<<(LINEDATA+4);
+		i=lcd44780gpioset(dev,lines);
+	}
+	return((i < 0) ? i : 0);
+}
+
+static int lcd44780gpio8send(lcd44780dev *dev, uint8_t *buf, int len) {
+/******************************************************************************/
+/*                                                                            */
+/* Each queued data/control pair, laid out as for an 8 bit MCP23017, sets the */
+/* lines once.                                                                */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	int i=0,count;
+	uint64_t lines;
+
+	for (count=0;(count+1<len)&&(i>=0);count+=2) {
+		lines=((buf[count+1] & dev->rsbit) ? LINERS : 0)|
+		      ((buf[count+1] & dev->enbit) ? LINEE : 0)|
+		      ((uint64_t)buf[count]<<LINEDATA);
+		if ((buf[count+1] & dev->blbit) && (dev->nlines > LINEDATA+8)) lines|=1ULL<<(LINEDATA+8);
+		i=lcd44780gpioset(dev,lines);
+	}
+	return((i < 0) ? i : 0);
+}
+
+static void lcd44780gpioend(lcd44780dev *dev) {
+/******************************************************************************/
+/*                                                                            */
+/* Release the lines (or the mock's copy of its file).                        */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	close(dev->fd);
+	return;
+}
+
+const lcd44780driver lcd44780gpio4drv={0, NULL, lcd44780queuestrobes, lcd44780gpionibble, lcd44780pcflight, lcd44780gpio4send, lcd44780gpioend, NULL, 0};
+const lcd44780driver lcd44780gpio8drv={1, NULL, lcd44780mcp17encode, lcd44780mcp17nibble, lcd44780mcp17light, lcd44780gpio8send, lcd44780gpioend, NULL, 0};
+
+static int lcd44780gpioattach(int fd, int bits, int nlines, uint8_t mock) {
+/******************************************************************************/
+/*                                                                            */
+/* Set up the library's state for a newly opened GPIO display.                */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	lcd44780dev *dev;
+	lcd44780pinmap pcf8574=LCD44780PINSPCF8574, mcp23017=LCD44780PINSMCP23017;
+
+	dev=lcd44780getdev(LCD44780NOPI,fd,1);
+	if (dev == NULL) {
+		close(fd);
+		lcd44780error_fprintf(NOMEMORY);
+		return (NOMEMORY);
+	}
+
+	if (bits == 8) {
+		dev->drv=&lcd44780gpio8drv;
+		lcd44780mappins(dev,&mcp23017);
+	}
+	else {
+		dev->drv=&lcd44780gpio4drv;
+		lcd44780mappins(dev,&pcf8574);
+	}
+	dev->backpack=LCD44780GPIO;
+	dev->mock=mock;
+	dev->nlines=nlines;
+	dev->lines=0;
+	dev->phase=0;
+	dev->setat=lcd44780clocknow();
+	lcd44780gpiodue(dev,0);
+
+	return (fd);
+}
+
+/* GPIO driver external library functions */
+
+int lcd44780gpioopen(char *chip, int rs, int en, int bl, int *data, int bits)
+/******************************************************************************/
+/*                                                                            */
+/* Open a display wired directly to GPIO lines of chip (e.g. "/dev/gpiochip0" */
+/* on a Raspberry Pi): rs and en are the RS and E line numbers, bl the line   */
+/* switching the backlight (-1 if there isn't one), and data the D4-D7        */
+/* (bits=4) or D0-D7 (bits=8) line numbers, e.g.                              */
+/*                                                                            */
+/*      int data[4]={23,24,25,8};                                             */
+/*      fd=lcd44780gpioopen("/dev/gpiochip0",7,22,-1,data,4);                 */
+/*      lcd44780init(LCD44780NOPI,fd,2,16);                                   */
+/*                                                                            */
+/* Returns the handle to use (with pi=LCD44780NOPI) for the display,          */
+/* BADSETTING, NOMEMORY, or NODEVICE if the lines can't be had.               */
+/* lcd44780close releases them.                                               */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+{
+	int i,fd,count;
+	struct gpio_v2_line_request req;
+
+	if ((bits != 4) && (bits != 8)) {
+		lcd44780error_fprintf(BADSETTING);
+		return (BADSETTING);
+	}
+
+	memset(&req,0,sizeof(req));
+	req.offsets[0]=rs;
+	req.offsets[1]=en;
+	for (count=0;count<bits;count++) req.offsets[LINEDATA+count]=data[count];
+	req.num_lines=LINEDATA+bits;
+	if (bl >= 0) req.offsets[req.num_lines++]=bl;
+	strcpy(req.consumer,"lcd44780");
+	req.config.flags=GPIO_V2_LINE_FLAG_OUTPUT;
+
+	fd=open(chip,O_RDWR|O_CLOEXEC);
+	if (fd < 0) {
+		lcd44780error_fprintf(NODEVICE);
+		return (NODEVICE);
+	}
+
+	i=ioctl(fd,GPIO_V2_GET_LINE_IOCTL,&req);
+	close(fd);
+	if (i < 0) {
+		lcd44780error_fprintf(NODEVICE);
+		return (NODEVICE);
+	}
+
+	return (lcd44780gpioattach(req.fd,bits,req.num_lines,0));
+}
+
+int lcd44780gpiomock(int fd, int bits)
+/******************************************************************************/
+/*                                                                            */
+/* Open a mock GPIO display (bits=4 or 8) for testing without hardware.       */
+/* Each time the lines would be set, with the same pacing as a real display,  */
+/* 6 bytes are written to fd (a file, pipe or socket) instead: the            */
+/* nanoseconds since the lines were last set (or the mock was opened), 32     */
+/* bits, then the line values, 16 bits, both little endian. Bit 0 is RS,      */
+/* bit 1 E, then come D4-D7 (bits=4) or D0-D7 (bits=8) and the backlight.     */
+/*                                                                            */
+/* Returns the handle to use (with pi=LCD44780NOPI), BADSETTING, NOMEMORY,    */
+/* or NODEVICE if fd can't be used. fd itself is left open by lcd44780close.  */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+{
+	int copy;
+
+	if ((bits != 4) && (bits != 8)) {
+		lcd44780error_fprintf(BADSETTING);
+		return (BADSETTING);
+	}
+
+	copy=dup(fd);
+	if (copy < 0) {
+		lcd44780error_fprintf(NODEVICE);
+		return (NODEVICE);
+	}
+
+	return (lcd44780gpioattach(copy,bits,LINEDATA+bits+1,1));
+}
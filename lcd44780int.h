@@ -0,0 +1,359 @@
+/******************************************************************************/
+/*                                                                            */
+/* Internal header file for                                                   */
+/* HD44780U LCD display library for I2C bus.                                  */
+/*                                                                            */
+/* Definitions shared between the library modules. Programs using the library */
+/* only need lcd44780.h.                                                      */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+#include "lcd44780.h"
+
+/* USDT probes (provider lcd44780) for perf, bpftrace and SystemTap, when     */
+/* <sys/sdt.h> is installed (systemtap-sdt-dev). Each is a nop until traced,  */
+/* and has a semaphore the tracer sets while it's attached - PROBEON(name) -  */
+/* so a probe's times are only taken while someone is listening.              */
+/*                                                                            */
+/*   enqueue(pi, fd, rs, count)         bytes handed to the backpack driver   */
+/*   dequeue(pi, fd, bytes)             queue about to be written to the bus  */
+/*   write(pi, fd, bytes, result, ns)   and written                           */
+/*   sleep(pi, fd, ns)                  delay taken                           */
+/*   commit(pi, fd, result, ns)         lcd44780commit (ns from first draw)   */
+/*   glyph(pi, fd, slot, rows)          CGRAM rows uploaded                   */
+/*   op(pi, fd, op, ns, busns)          LCD44780OP... finished (see latency)  */
+
+#if defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#define _SDT_HAS_SEMAPHORES 1
+#include <sys/sdt.h>
+#define PROBE3(name,a,b,c)              DTRACE_PROBE3(lcd44780,name,a,b,c)
+#define PROBE4(name,a,b,c,d)            DTRACE_PROBE4(lcd44780,name,a,b,c,d)
+#define PROBE5(name,a,b,c,d,e)          DTRACE_PROBE5(lcd44780,name,a,b,c,d,e)
+#define PROBEON(name)                   __builtin_expect(lcd44780_##name##_semaphore != 0,0)
+#define PROBESEMAPHORE(name)            volatile unsigned short lcd44780_##name##_semaphore \
+                                        __attribute__((section(".probes")))
+extern volatile unsigned short lcd44780_enqueue_semaphore, lcd44780_dequeue_semaphore;
+extern volatile unsigned short lcd44780_write_semaphore, lcd44780_sleep_semaphore;
+extern volatile unsigned short lcd44780_commit_semaphore, lcd44780_glyph_semaphore;
+extern volatile unsigned short lcd44780_op_semaphore;
+#endif
+#endif
+
+#ifndef PROBE3					// Arguments still count as used, but aren't worked out
+#define PROBE3(name,a,b,c)              do { if (0) { (void)(a); (void)(b); (void)(c); } } while (0)
+#define PROBE4(name,a,b,c,d)            do { if (0) { (void)(a); (void)(b); (void)(c); (void)(d); } } while (0)
+#define PROBE5(name,a,b,c,d,e)          do { if (0) { (void)(a); (void)(b); (void)(c); (void)(d); (void)(e); } } while (0)
+#define PROBEON(name)                   0
+#endif
+
+/* 44780 LCD library error codes */
+
+#define ROWTOOLOW       -1000   // Row specified as lower than ORIGIN
+#define ROWTOOHIGH      -1001   // Page specified as higher than lcdrows+ORIGIN
+#define COLOUTOFRANGE   -1002   // Column is lower than ORIGIN or higher than ORIGIN+lcdcols
+#define COLTOOLOW       -1003   // Column specified as lower than ORIGIN
+#define COLTOOHIGH      -1004   // Column specified as higher than lcdcols+ORIGIN
+#define NOMEMORY        -1005   // Unable to allocate the state for a display
+#define SLOTOUTOFRANGE  -1006   // CGRAM slot or glyph number out of range
+#define BANKSOFF        -1007   // Glyph banks have not been enabled
+#define NOGLYPHSLOT     -1008   // No free CGRAM slot for a user defined character
+#define BADWIDGET       -1009   // Widget type, size or range not valid
+#define BADSETTING      -1010   // Setting not one of the values allowed
+#define NODEVICE        -1011   // Unable to open or set up the display's device
+#define LASTERROR       NODEVICE
+
+/* 44780 LCD general definitions */
+
+#define ORIGIN          1       // Defines the origin point for the library.
+                                // Default is 1 - top line of the display, and
+                                // also for the first character of any line to make
+                                // the library a little more FORTRAN friendly.
+                                // It should work with ORIGIN=0 (or any other value)
+                                // but this is untested.
+
+/* 44780 LCD (HD44780U) instruction set */
+
+#define CLEARDISPLAY            0x01
+#define CURSORHOME              0x02
+#define ENTRYMODESET            0x04
+#define DISPLAYCONTROL          0x08
+#define CURSORMOVE              0x10
+#define FUNCTIONSET             0x20
+#define CGRAMSETADDR            0x40
+#define DDRAMSETADDR            0x80
+
+/* 44780 LCD (HD44780U) instruction set flags */
+
+// Combined with ENTRYMODESET instruction (bitwise or required)
+#define ENTRYDEC                0x00
+#define ENTRYINC                0x01
+#define ENTRYRIGHT              0x00
+#define ENTRYLEFT               0x02
+// Combined with DISPLAYCONTROL instruction (bitwise or required)
+#define BLINKOFF                0x00
+#define BLINKON                 0x01
+#define CURSOROFF               0x00
+#define CURSORON                0x02
+#define DISPLAYOFF              0x00
+#define DISPLAYON               0x04
+// Combined with CURSORMOVE instuction (bitwise or required)
+#define GOLEFT                  0x00
+#define GORIGHT                 0x04
+#define GOCURSOR                0x00
+#define GODISPLAY               0x08
+// Combined with FUNCTIONSET instruction (bitwise or required)
+#define CHAR5X8                 0x00
+#define CHAR5X10                0x04
+#define ONELINE                 0x00
+#define TWOLINE                 0x08
+#define FOURBIT                 0x00
+#define EIGHTBIT                0x10
+
+// Other pins (used by the PCF8574 backpack, as usually wired - see lcd44780setpins)
+#define BACKLIGHT               0x08
+#define ENABLE                  0x04
+#define READWRITE               0x02
+#define REGISTERSET             0x01
+
+// Where the data lines sit on the backpack, which decides the encoders that can be used
+#define LAYOUTHIGH              0       // D4-D7 on P4-P7
+#define LAYOUTLOW               1       // D4-D7 on P0-P3
+#define LAYOUTOTHER             2       // Anything else - strobe table only
+#define LAYOUTS                 3
+
+/* 44780 LCD (HD44780U) memory layout */
+
+#define DDRAMSIZE               0x80    // DDRAM address space (0x00-0x27 and 0x40-0x67 in 2 line mode)
+#define CGRAMSLOTS              8       // Number of user defined characters (5x8 font)
+#define CGRAMAC                 0x100   // Flags an address counter value as a CGRAM address
+#define ACUNKNOWN               -1      // Address counter position is not known
+#define BANKGLYPHS              4       // Logical glyphs available when CGRAM is split into two banks
+#define GLYPHPINNED             0xFF    // Reference count of a slot owned by lcd44780defchar or the banks
+#define SYNTHGLYPHS             9       // Characters in the built in font used when the ROM lacks one
+#define UTF8TERMINATED          0x7FFFFFFF // lcd44780utf8cells - no limit but the string's terminator
+
+#define MAXDEVS                 64      // Maximum number of displays the library keeps state for
+#define COUNT(dev,counter,n)    __atomic_fetch_add(&(dev)->stats.counter,(n),__ATOMIC_RELAXED)
+#define HISTSUBBITS             4       // Latency histograms - buckets per doubling (as a power of 2)
+#define HISTSUB                 (1<<HISTSUBBITS)
+#define HISTTOP                 36      // Highest bit of the longest latency kept apart (~69s)
+#define HISTBUCKETS             ((HISTTOP-HISTSUBBITS+2)*HISTSUB)
+#define TRACESEND               0       // Trace entry types - a write to the bus
+#define TRACESLEEP              1       // or a delay
+#define TRACING()               __builtin_expect(lcd44780tracering != NULL,0)
+#define TIMING()                __builtin_expect(lcd44780timingon != 0,0)
+#define OUTSIZE                 512     // Bytes queued for a display before they must be sent
+#define EXECNS                  37000   // HD44780U execution time of most instructions and data writes
+#define I2CBYTECLOCKS           9       // I2C clocks per byte - 8 bits and the acknowledge
+#define CANVASMAXW              20      // Maximum canvas width in cells
+#define CANVASMAXH              4       // Maximum canvas height in cells
+
+// Pixel canvas, drawn into a packed bit plane (1 bit per pixel, MSB leftmost)
+
+typedef struct {
+	uint8_t row;				// Top left cell, counted from 0
+	uint8_t col;
+	uint8_t width;				// Size in cells
+	uint8_t height;
+	uint8_t plane[CANVASMAXH*8][(CANVASMAXW*5+7)/8];
+	uint8_t dirty[CANVASMAXH*CANVASMAXW];	// Cells drawn on since the last commit
+	int8_t slot[CANVASMAXH*CANVASMAXW];	// CGRAM slot owned by each cell (-1 = ROM character)
+} lcd44780canvas;
+
+// Latency histogram - log-linear, like HdrHistogram: exact below HISTSUB ns, then HISTSUB
+// buckets for each doubling, so every bucket is within 1/HISTSUB of the latencies in it
+
+typedef struct {
+	uint64_t count;				// Latencies recorded
+	uint64_t max;				// and the longest
+	uint32_t bucket[HISTBUCKETS];
+} lcd44780histogram;
+
+// Trace ring entry - one write to the bus or one delay
+
+typedef struct {
+	uint64_t seq;				// Entry number plus 1, or 0 while it's being written
+	uint64_t at;				// Start time and
+	uint64_t ns;				// length in nanoseconds
+	int32_t pi;				// Display
+	int32_t fd;
+	int32_t result;				// What the write returned (TRACESEND)
+	uint32_t bytes;				// Bytes written
+	uint16_t commands;			// and what they carried - instructions,
+	uint16_t addrs;				// of which set address instructions,
+	uint16_t data;				// and data writes
+	uint8_t type;				// TRACESEND or TRACESLEEP
+} lcd44780traceentry;
+
+// Trace ring - writers each claim the next entry, the oldest being overwritten
+
+typedef struct {
+	uint64_t mask;				// Entries (a power of 2) less 1
+	uint64_t head;				// Entries ever claimed
+	lcd44780traceentry entry[];
+} lcd44780tracebuf;
+
+// Start of an operation being timed
+
+typedef struct {
+	uint8_t timed;				// Timing was on when it was called
+	uint8_t probed;				// The op probe was being traced then
+	uint64_t start;				// When it was called
+	uint64_t bus;				// and the display's busclock then
+} lcd44780latmark;
+
+// 44780 LCD per display state
+
+typedef struct {
+	int pi;					// pigpiod connection and
+	int fd;					// I2C handle identifying the display
+	const struct lcd44780driver *drv;	// Backpack driver
+	uint8_t backpack;			// and which one it is (LCD44780PCF8574 etc.)
+	char bl;				// Backlight bits included in every byte sent (0x08 or 0x00 usually)
+	uint8_t blon;				// Backlight on (1) or off (0)
+	uint8_t rgb;				// Backlight colours lit when on (RGB plate only, else all)
+	uint32_t hz;				// SPI clock, or the simulated I2C bus's
+	uint8_t pad;				// Idle bytes after each byte's strobes (fast I2C buses)
+	uint8_t mock;				// Writes go to a file instead of the bus (SPI and GPIO mocks)
+	uint8_t phase;				// Enable pulses sent for the current instruction (SPI)
+	uint8_t last;				// Last byte sent (SPI)
+	uint8_t nlines;				// GPIO lines requested
+	uint64_t lines;				// and their current values
+	uint64_t due;				// Time the lines may next change (GPIO)
+	uint64_t setat;				// and when they were last set (GPIO mock)
+	int cursor;				// DDRAM address of the kernel driver's cursor, or ACUNKNOWN (charlcd)
+	uint8_t cgpending;			// Bit n set - character n needs sending to the kernel (charlcd)
+	int handle;				// pigpiod's I2C handle (pigpiod socket)
+	uint32_t sent;				// Writes sent to the bus
+	uint32_t done;				// and replied to (pigpiod socket)
+	uint8_t reply[16];			// Reply being read
+	int replylen;
+	uint8_t pigsmode;			// LCD44780PIGSWRITE or LCD44780PIGSZIP
+	struct lcd44780sim *sim;		// Simulated display (simulator)
+	uint64_t busfree;			// Time the simulated bus is next free
+	uint64_t overhead;			// and nanoseconds each write takes before its bytes start
+	int syncerr;				// First error reported since lcd44780sync
+	uint32_t syncerrseq;			// and the write it came from (1 = first)
+	lcd44780pinmap pins;			// Backpack wiring
+	uint8_t layout;				// LAYOUTHIGH, LAYOUTLOW or LAYOUTOTHER
+	uint8_t rsbit;				// Register set, enable and backlight bits
+	uint8_t enbit;				// for the wiring in use
+	uint8_t blbit;
+	uint8_t nibble[16];			// Data line bits for each 4 bit value
+	uint8_t rows;				// Number of rows on the LCD (1,2 or 4, typically)
+	uint8_t cols;				// Number of columns on the LCD (16 or 20 typically)
+	uint8_t inc;				// 1 if the address counter increments after a write
+	int ac;					// Address counter (DDRAM address, CGRAMAC|CGRAM address or ACUNKNOWN)
+	uint8_t ddram[DDRAMSIZE];		// Shadow copy of the characters held by the HD44780U
+	uint8_t fb[DDRAMSIZE];			// Characters the display should hold after the next commit
+	uint8_t cgram[CGRAMSLOTS][8];		// Shadow copy of the user defined characters
+	uint8_t cgvalid;			// Bit n set - slot n has been written since power up
+	uint8_t cgref[CGRAMSLOTS];		// Glyph cache users of each slot (GLYPHPINNED = not shared)
+	int8_t barglyph[3][8];			// Glyph cache slots held for each bar type (-1 = not loaded)
+	int8_t bigglyph[4];			// Glyph cache slots held for big numerals (-1 = not loaded)
+	lcd44780canvas *canvas;			// Pixel canvas, if one has been set up
+	uint8_t rom;				// Character ROM fitted (LCD44780ROMA00, LCD44780ROMA02 or LCD44780ROMRAW)
+	int8_t synth[SYNTHGLYPHS];		// Glyph cache slots held for the built in font (-1 = not loaded)
+	uint8_t strobes[2][256][4];		// Bytes to send for each command (0) and data (1) byte
+	uint8_t out[OUTSIZE];			// Bytes queued to send
+	int outlen;
+	int hold;				// Frames being built - queue isn't sent until this is 0
+	int err;				// First error from a write in the current frame
+	uint8_t banks;				// CGRAM split into two banks of BANKGLYPHS slots
+	uint8_t bank;				// Bit n set - logical glyph n is shown from the upper bank
+	uint8_t staged;				// Bit n set - logical glyph n is waiting in its inactive slot
+	lcd44780counters stats;			// Counters, updated atomically
+	FILE *statsfile;			// Where they're dumped (lcd44780statsdump), or NULL
+	uint64_t statsevery;			// and how often, in nanoseconds
+	uint64_t statsdue;			// Time of the next dump
+	uint64_t busclock;			// Nanoseconds spent writing to the bus, never reset
+	uint8_t priority;			// Priority class operations are timed under
+	uint64_t drawnat;			// Time of the first lcd44780draw since the last commit, or 0
+	lcd44780histogram lat[LCD44780OPS][2];	// Latencies of each operation, as seen and on the bus
+	uint16_t tracecmds;			// Instructions,
+	uint16_t traceaddrs;			// set address instructions
+	uint16_t tracedata;			// and data queued since the last write (while tracing)
+	struct lcd44780capture *vcd;		// Pin capture (lcd44780vcd), or NULL
+	FILE *rec;				// Session recording (lcd44780record), or NULL
+	int recdepth;				// Recorded calls under way
+	uint64_t recat;				// Time of the last record
+} lcd44780dev;
+
+// Backpack driver - how bytes for the HD44780U are encoded and reach the bus
+
+typedef struct lcd44780driver {
+	uint8_t eightbit;						// HD44780U driven in 8 bit mode
+	int (*begin)(lcd44780dev *dev);					// Set the backpack up (from lcd44780init), or NULL
+	void (*encode)(lcd44780dev *dev, uint8_t rs, uint8_t *src, int len);	// Queue bytes for a register
+	void (*nibble)(lcd44780dev *dev, uint8_t data);			// Queue an 8 bit instruction's high nibble (init only)
+	void (*light)(lcd44780dev *dev);				// Queue the backlight setting
+	int (*send)(lcd44780dev *dev, uint8_t *buf, int len);		// Write queued bytes to the bus
+	void (*end)(lcd44780dev *dev);					// Release the bus (from lcd44780close), or NULL
+	int (*sync)(lcd44780dev *dev);					// Wait for sent bytes to arrive, or NULL
+	uint8_t selftimed;						// Driver waits for each instruction itself - no delays
+} lcd44780driver;
+
+#define RGBRED                  0x01    // lcd44780dev rgb bits
+#define RGBGREEN                0x02
+#define RGBBLUE                 0x04
+#define RGBALL                  0x07
+
+extern lcd44780tracebuf *lcd44780tracering;
+extern uint8_t lcd44780timingon;
+
+extern const lcd44780driver lcd44780pcf8574drv;
+extern const lcd44780driver lcd44780mcp23008drv;
+extern const lcd44780driver lcd44780mcp23017drv;
+extern const lcd44780driver lcd44780rgbplatedrv;
+extern const lcd44780driver lcd44780spi595drv;
+extern const lcd44780driver lcd44780gpio4drv;
+extern const lcd44780driver lcd44780gpio8drv;
+extern const lcd44780driver lcd44780charlcddrv;
+extern const lcd44780driver lcd44780pigsdrv;
+extern const lcd44780driver lcd44780simdrv;
+
+/* HD44780U internal library functions shared between modules */
+
+extern lcd44780dev *lcd44780getdev(int pi, int fd, int create);
+extern lcd44780dev *lcd44780finddev(int pi, int fd);
+extern void lcd44780buildstrobes(lcd44780dev *dev);
+extern int lcd44780flush(lcd44780dev *dev);
+extern int lcd44780queue(lcd44780dev *dev, uint8_t *bytes, int len);
+extern void lcd44780hold(lcd44780dev *dev);
+extern int lcd44780release(lcd44780dev *dev);
+extern void lcd44780delay(lcd44780dev *dev, long ns);
+extern void lcd44780encodebytes(lcd44780dev *dev, uint8_t rs, uint8_t *src, int len, uint8_t *out);
+extern int lcd44780writebulk(lcd44780dev *dev, uint8_t rs, uint8_t *src, int len);
+extern void lcd44780queuestrobes(lcd44780dev *dev, uint8_t rs, uint8_t *src, int len);
+extern uint8_t lcd44780buspad(uint32_t hz);
+extern void lcd44780mappins(lcd44780dev *dev, lcd44780pinmap *map);
+extern void lcd44780pcfnibble(lcd44780dev *dev, uint8_t data);
+extern void lcd44780pcflight(lcd44780dev *dev);
+extern void lcd44780mcp17encode(lcd44780dev *dev, uint8_t rs, uint8_t *src, int len);
+extern void lcd44780mcp17nibble(lcd44780dev *dev, uint8_t data);
+extern void lcd44780mcp17light(lcd44780dev *dev);
+extern uint8_t lcd44780ddaddr(int row, int col);
+extern int lcd44780nextaddr(lcd44780dev *dev, int ac);
+extern int lcd44780checkpos(lcd44780dev *dev, uint8_t row, uint8_t col);
+extern char lcd44780glyphmap(lcd44780dev *dev, char c);
+extern int lcd44780freeslot(lcd44780dev *dev);
+extern int lcd44780loadglyph(lcd44780dev *dev, uint8_t *bitmap);
+extern int lcd44780commitdev(lcd44780dev *dev);
+extern int lcd44780setpos(int pi, int fd, int row, int col);
+extern int lcd44780utf8len(lcd44780dev *dev, char *src);
+extern int lcd44780utf8cells(lcd44780dev *dev, char *src, int srclen, uint8_t *cells, int maxcells);
+extern void lcd44780statsdue(lcd44780dev *dev);
+extern void lcd44780tracequeue(lcd44780dev *dev, uint8_t rs, uint8_t *src, int len);
+extern void lcd44780traceadd(lcd44780dev *dev, uint8_t type, uint64_t at, uint64_t ns, uint32_t bytes, int result);
+extern void lcd44780vcdframe(lcd44780dev *dev, uint64_t start, uint64_t ns);
+extern void lcd44780vcdend(lcd44780dev *dev);
+extern void lcd44780reccall(lcd44780dev *dev, uint8_t op, int nargs, int *args, char *bytes, int len);
+extern void lcd44780recend(lcd44780dev *dev, int result);
+extern void lcd44780recwrite(lcd44780dev *dev, uint64_t start, uint64_t ns, int result);
+extern void lcd44780latstart(lcd44780dev *dev, lcd44780latmark *mark);
+extern void lcd44780latend(lcd44780dev *dev, uint8_t op, lcd44780latmark *mark);
+extern uint64_t lcd44780clocknow(void);
+extern void lcd44780clocksleep(uint64_t ns);
+extern void lcd44780clockuntil(uint64_t due);
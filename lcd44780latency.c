@@ -0,0 +1,251 @@
+/******************************************************************************/
+/*                                                                            */
+/* Latency histograms for the HD44780U LCD display library for I2C bus.       */
+/*                                                                            */
+/* Each of lcd44780str, chr, clearline, clear, commit and init is timed from  */
+/* the call until everything it sends has been written and waited for, and    */
+/* for the time spent writing to the bus alone. Latencies go into fixed size  */
+/* log-linear histograms (in the style of HdrHistogram) kept for each display */
+/* and for each priority class (see lcd44780setpriority) across displays, so  */
+/* the tail isn't lost in an average. Times are on the library's clock.       */
+/*                                                                            */
+/* Nothing is timed until lcd44780settiming turns timing on, though the op    */
+/* probe (see lcd44780int.h) still reports each operation while it's traced.  */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+#include "lcd44780int.h"
+
+static lcd44780histogram prioritylat[LCD44780PRIORITIES][LCD44780OPS][2];
+
+/* Latency internal library functions */
+
+static int lcd44780histindex(uint64_t ns) {
+/******************************************************************************/
+/*                                                                            */
+/* Bucket a latency falls in. Latencies beyond the last bucket are put in it. */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	int top;
+
+	if (ns < HISTSUB) return ((int)ns);
+
+	top=63-__builtin_clzll(ns);
+	if (top > HISTTOP) return (HISTBUCKETS-1);
+
+	return ((top-HISTSUBBITS+1)*HISTSUB+(int)((ns>>(top-HISTSUBBITS))&(HISTSUB-1)));
+}
+
+static uint64_t lcd44780histvalue(int index) {
+/******************************************************************************/
+/*                                                                            */
+/* Longest latency that falls in a bucket.                                    */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	int shift;
+
+	if (index < HISTSUB) return ((uint64_t)index);
+
+	shift=index/HISTSUB-1;
+	return ((((uint64_t)(HISTSUB+index%HISTSUB)+1)<<shift)-1);
+}
+
+static void lcd44780histadd(lcd44780histogram *h, uint64_t ns) {
+/******************************************************************************/
+/*                                                                            */
+/* Record a latency. Atomic, so displays on different threads can share the   */
+/* priority class histograms.                                                 */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	uint64_t max;
+
+	__atomic_fetch_add(&h->bucket[lcd44780histindex(ns)],1,__ATOMIC_RELAXED);
+	__atomic_fetch_add(&h->count,1,__ATOMIC_RELAXED);
+
+	max=__atomic_load_n(&h->max,__ATOMIC_RELAXED);
+	while ((ns > max) && !__atomic_compare_exchange_n(&h->max,&max,ns,1,__ATOMIC_RELAXED,__ATOMIC_RELAXED));
+	return;
+}
+
+static void lcd44780histread(lcd44780histogram *h, lcd44780percentiles *p, uint8_t reset) {
+/******************************************************************************/
+/*                                                                            */
+/* Summarise a histogram, emptying it if reset is non zero. Each percentile   */
+/* is the longest latency in the bucket it falls in (but never beyond max).   */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	static const uint32_t per10000[3]={5000,9900,9990};
+	uint64_t *result[3]={&p->p50,&p->p99,&p->p999};
+	uint64_t seen=0,want;
+	uint32_t n,copy[HISTBUCKETS];
+	int count,next=0;
+
+	p->count=0;
+	p->max=(reset) ? __atomic_exchange_n(&h->max,0,__ATOMIC_RELAXED) : __atomic_load_n(&h->max,__ATOMIC_RELAXED);
+	p->p50=p->p99=p->p999=0;
+
+	for (count=0;count<HISTBUCKETS;count++) {
+		if (reset) copy[count]=__atomic_exchange_n(&h->bucket[count],0,__ATOMIC_RELAXED);
+		else copy[count]=__atomic_load_n(&h->bucket[count],__ATOMIC_RELAXED);
+		p->count+=copy[count];
+	}
+	if (reset) __atomic_fetch_sub(&h->count,p->count,__ATOMIC_RELAXED);
+	if (p->count == 0) return;
+
+	for (count=0;(count<HISTBUCKETS)&&(next<3);count++) {
+		n=copy[count];
+		if (n == 0) continue;
+		seen+=n;
+		while (next < 3) {
+			want=(p->count*per10000[next]+9999)/10000;
+			if (seen < want) break;
+			*result[next]=lcd44780histvalue(count);
+			if (*result[next] > p->max) *result[next]=p->max;
+			next++;
+		}
+	}
+	return;
+}
+
+void lcd44780latstart(lcd44780dev *dev, lcd44780latmark *mark) {
+/******************************************************************************/
+/*                                                                            */
+/* Note the start of an operation to be timed.                                */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	mark->timed=TIMING();
+	mark->probed=PROBEON(op);
+	mark->start=((mark->timed) || (mark->probed)) ? lcd44780clocknow() : 0;
+	mark->bus=dev->busclock;
+	return;
+}
+
+void lcd44780latend(lcd44780dev *dev, uint8_t op, lcd44780latmark *mark) {
+/******************************************************************************/
+/*                                                                            */
+/* Record an operation's latencies for the display and its priority class.    */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	uint64_t visible,bus;
+
+	if ((mark->timed == 0) && (mark->probed == 0)) return;
+
+	visible=lcd44780clocknow()-mark->start;
+	bus=dev->busclock-mark->bus;
+	PROBE5(op,dev->pi,dev->fd,op,visible,bus);
+	if (mark->timed == 0) return;			// Only the probe was listening
+
+	lcd44780histadd(&dev->lat[op][LCD44780LATVISIBLE],visible);
+	lcd44780histadd(&dev->lat[op][LCD44780LATBUS],bus);
+	lcd44780histadd(&prioritylat[dev->priority][op][LCD44780LATVISIBLE],visible);
+	lcd44780histadd(&prioritylat[dev->priority][op][LCD44780LATBUS],bus);
+	return;
+}
+
+/* Latency external library functions */
+
+int lcd44780setpriority(int pi, int fd, uint8_t priority)
+/******************************************************************************/
+/*                                                                            */
+/* Set the priority class (0 to LCD44780PRIORITIES-1, 0 by default) the       */
+/* display's operations are timed under from now on - e.g. 1 for a display    */
+/* showing alarms - so each class's latencies can be read on their own with   */
+/* lcd44780prioritylatency.                                                   */
+/*                                                                            */
+/* Returns 0, NOMEMORY, or BADSETTING if priority is out of range.            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+{
+	lcd44780dev *dev;
+
+	if (priority >= LCD44780PRIORITIES) {
+		lcd44780error_fprintf(BADSETTING);
+		return (BADSETTING);
+	}
+
+	dev=lcd44780getdev(pi,fd,1);
+	if (dev == NULL) {
+		lcd44780error_fprintf(NOMEMORY);
+		return (NOMEMORY);
+	}
+
+	dev->priority=priority;
+	return (0);
+}
+
+int lcd44780latency(int pi, int fd, uint8_t op, uint8_t kind, lcd44780percentiles *p, uint8_t reset)
+/******************************************************************************/
+/*                                                                            */
+/* Percentiles of a display's latencies for operation op (LCD44780OPSTR etc.) */
+/* - as seen (LCD44780LATVISIBLE) or on the bus alone (LCD44780LATBUS). If    */
+/* reset is non zero the histogram is emptied.                                */
+/*                                                                            */
+/* Returns 0, NOMEMORY, or BADSETTING if op or kind is out of range.          */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+{
+	lcd44780dev *dev;
+
+	if ((op >= LCD44780OPS) || (kind > LCD44780LATBUS)) {
+		lcd44780error_fprintf(BADSETTING);
+		return (BADSETTING);
+	}
+
+	dev=lcd44780getdev(pi,fd,1);
+	if (dev == NULL) {
+		lcd44780error_fprintf(NOMEMORY);
+		return (NOMEMORY);
+	}
+
+	lcd44780histread(&dev->lat[op][kind],p,reset);
+	return (0);
+}
+
+int lcd44780prioritylatency(uint8_t priority, uint8_t op, uint8_t kind, lcd44780percentiles *p, uint8_t reset)
+/******************************************************************************/
+/*                                                                            */
+/* As lcd44780latency, but for every display in a priority class.             */
+/*                                                                            */
+/* Returns 0, or BADSETTING if priority, op or kind is out of range.          */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+{
+	if ((priority >= LCD44780PRIORITIES) || (op >= LCD44780OPS) || (kind > LCD44780LATBUS)) {
+		lcd44780error_fprintf(BADSETTING);
+		return (BADSETTING);
+	}
+
+	lcd44780histread(&prioritylat[priority][op][kind],p,reset);
+	return (0);
+}
@@ -0,0 +1,332 @@
+/******************************************************************************/
+/*                                                                            */
+/* MCP23008 and MCP23017 backpack drivers for the HD44780U LCD display        */
+/* library for I2C bus.                                                       */
+/*                                                                            */
+/* The expanders are put into byte mode (IOCON SEQOP set), so a whole frame   */
+/* goes out as one I2C write: the GPIO register address, then every byte for  */
+/* it. On an MCP23008, or port B of the RGB plate (IOCON BANK set), the       */
+/* address pointer stays put; in 8 bit mode on an MCP23017 (BANK clear) it    */
+/* toggles between GPIOA and GPIOB, so bytes are queued in data/control       */
+/* pairs.                                                                     */
+/*                                                                            */
+/* Bytes on the bus per character, after the register address:                */
+/*                                                                            */
+/*      4 bit mode (MCP23008, RGB plate) - 4, as for the PCF8574              */
+/*      8 bit mode (MCP23017)            - 4, two data/control pairs, but     */
+/*                                         only one enable pulse and one      */
+/*                                         HD44780U bus cycle instead of two  */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+#include "lcd44780int.h"
+
+// MCP23008 registers
+
+#define MCP08IODIR              0x00
+#define MCP08IOCON              0x05
+#define MCP08GPIO               0x09
+
+// MCP23017 registers with IOCON BANK clear (8 bit mode) ...
+
+#define MCP17IODIRA             0x00
+#define MCP17IOCON              0x0A
+#define MCP17GPIOA              0x12
+
+// ... and set (RGB plate)
+
+#define MCP17BIODIRA            0x00
+#define MCP17BIODIRB            0x10
+#define MCP17BIOCON             0x05
+#define MCP17BGPIOA             0x09
+#define MCP17BGPIOB             0x19
+
+// IOCON bits
+
+#define IOCONBANK               0x80
+#define IOCONSEQOP              0x20
+
+// RGB plate red and green LEDs (port A, lit when low)
+
+#define PLATERED                0x40
+#define PLATEGREEN              0x80
+
+/* MCP backpack internal library functions */
+
+static int lcd44780mcpwrite(lcd44780dev *dev, uint8_t reg, uint8_t *buf, int len) {
+/******************************************************************************/
+/*                                                                            */
+/* Write len bytes to the expander, starting at register reg.                 */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	char msg[OUTSIZE+1];
+
+	msg[0]=reg;
+	memcpy(msg+1,buf,len);
+
+	return(i2c_write_device(dev->pi,dev->fd,msg,len+1));
+}
+
+static int lcd44780mcpsetreg(lcd44780dev *dev, uint8_t reg, uint8_t value) {
+/******************************************************************************/
+/*                                                                            */
+/* Set a single expander register.                                            */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	return(lcd44780mcpwrite(dev,reg,&value,1));
+}
+
+/* MCP23008 (4 bit mode) */
+
+static int lcd44780mcp08begin(lcd44780dev *dev) {
+/******************************************************************************/
+/*                                                                            */
+/* Byte mode, all pins outputs.                                               */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	int i;
+
+	i=lcd44780mcpsetreg(dev,MCP08IOCON,IOCONSEQOP);
+	if (i >= 0) i=lcd44780mcpsetreg(dev,MCP08IODIR,0x00);
+	return(i);
+}
+
+static int lcd44780mcp08send(lcd44780dev *dev, uint8_t *buf, int len) {
+/******************************************************************************/
+/*                                                                            */
+/* Everything goes to the GPIO register.                                      */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	return(lcd44780mcpwrite(dev,MCP08GPIO,buf,len));
+}
+
+const lcd44780driver lcd44780mcp23008drv={0, lcd44780mcp08begin, lcd44780queuestrobes, lcd44780pcfnibble, lcd44780pcflight, lcd44780mcp08send, NULL, NULL, 0};
+
+/* MCP23017 (8 bit mode) */
+
+static int lcd44780mcp17begin(lcd44780dev *dev) {
+/******************************************************************************/
+/*                                                                            */
+/* Byte mode with BANK clear, so writes alternate between the A and B         */
+/* registers, and all pins outputs. Register 0x05 is IOCON if the expander    */
+/* was left with BANK set, and an unused interrupt enable register if not,    */
+/* so clearing it first gets us to a known bank either way.                   */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	int i;
+	uint8_t dir[2]={0x00, 0x00};
+
+	i=lcd44780mcpsetreg(dev,MCP17BIOCON,0x00);
+	if (i >= 0) i=lcd44780mcpsetreg(dev,MCP17IOCON,IOCONSEQOP);
+	if (i >= 0) i=lcd44780mcpwrite(dev,MCP17IODIRA,dir,2);	// IODIRA, IODIRB
+	return(i);
+}
+
+void lcd44780mcp17encode(lcd44780dev *dev, uint8_t rs, uint8_t *src, int len) {
+/******************************************************************************/
+/*                                                                            */
+/* Queue each byte as two GPIOA/GPIOB pairs - the data with enable high, then */
+/* the data again with enable low. Also used by other 8 bit mode drivers.     */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	int count,pad;
+	uint8_t flags, *out;
+
+	flags=dev->bl|((rs) ? dev->rsbit : 0x00);
+
+	for (count=0;count<len;count++) {
+		if (dev->outlen+4+dev->pad+1 > OUTSIZE) lcd44780flush(dev);
+
+		out=dev->out+dev->outlen;
+		out[0]=src[count];
+		out[1]=flags|dev->enbit;
+		out[2]=src[count];
+		out[3]=flags;
+		dev->outlen+=4;
+
+		for (pad=0;pad<dev->pad;pad+=2) {	// Idle pairs on a fast bus (see lcd44780buspad)
+			out[4+pad]=src[count];
+			out[5+pad]=flags;
+			dev->outlen+=2;
+		}
+	}
+	return;
+}
+
+void lcd44780mcp17nibble(lcd44780dev *dev, uint8_t data) {
+/******************************************************************************/
+/*                                                                            */
+/* An 8 bit mode instruction is sent whole anyway - just shift it back into   */
+/* place.                                                                     */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	uint8_t cmd;
+
+	cmd=(data<<4)&0xF0;
+	lcd44780mcp17encode(dev,0,&cmd,1);
+	return;
+}
+
+void lcd44780mcp17light(lcd44780dev *dev) {
+/******************************************************************************/
+/*                                                                            */
+/* Queue the backlight bit as a data/control pair, enable low.                */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	uint8_t pair[2];
+
+	pair[0]=0x00;
+	pair[1]=dev->bl;
+	lcd44780queue(dev,pair,2);
+	return;
+}
+
+static int lcd44780mcp17send(lcd44780dev *dev, uint8_t *buf, int len) {
+/******************************************************************************/
+/*                                                                            */
+/* Pairs go to GPIOA then GPIOB.                                              */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	return(lcd44780mcpwrite(dev,MCP17GPIOA,buf,len));
+}
+
+const lcd44780driver lcd44780mcp23017drv={1, lcd44780mcp17begin, lcd44780mcp17encode, lcd44780mcp17nibble, lcd44780mcp17light, lcd44780mcp17send, NULL, NULL, 0};
+
+/* Adafruit RGB LCD plate (MCP23017, 4 bit mode on port B) */
+
+static void lcd44780platelight(lcd44780dev *dev) {
+/******************************************************************************/
+/*                                                                            */
+/* Red and green are on port A, so set them straight away (after anything     */
+/* already queued), then queue blue with the rest of port B.                  */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	int i;
+	uint8_t leds=PLATERED|PLATEGREEN;
+
+	if (dev->blon) {
+		if (dev->rgb & RGBRED) leds&=~PLATERED;
+		if (dev->rgb & RGBGREEN) leds&=~PLATEGREEN;
+	}
+
+	lcd44780flush(dev);
+	i=lcd44780mcpsetreg(dev,MCP17BGPIOA,leds);
+	if ((i < 0) && (dev->err == 0)) dev->err=i;
+
+	lcd44780queue(dev,(uint8_t *)&dev->bl,1);
+	return;
+}
+
+static int lcd44780platebegin(lcd44780dev *dev) {
+/******************************************************************************/
+/*                                                                            */
+/* Byte mode with BANK set, so port B can be written over and over. Register  */
+/* 0x0A is IOCON if BANK is clear, and OLATA (fixed below) if it's already    */
+/* set; either way 0x05 is IOCON after it. Port A's buttons stay inputs.      */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	int i;
+
+	i=lcd44780mcpsetreg(dev,MCP17IOCON,IOCONBANK|IOCONSEQOP);
+	if (i >= 0) i=lcd44780mcpsetreg(dev,MCP17BIOCON,IOCONBANK|IOCONSEQOP);
+	if (i >= 0) i=lcd44780mcpsetreg(dev,MCP17BIODIRA,(uint8_t)~(PLATERED|PLATEGREEN));
+	if (i >= 0) i=lcd44780mcpsetreg(dev,MCP17BIODIRB,0x00);
+	if (i >= 0) {
+		dev->err=0;
+		lcd44780platelight(dev);
+		i=lcd44780flush(dev);
+		if (dev->err < 0) i=dev->err;
+	}
+	return(i);
+}
+
+static int lcd44780platesend(lcd44780dev *dev, uint8_t *buf, int len) {
+/******************************************************************************/
+/*                                                                            */
+/* Everything else goes to GPIOB.                                             */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	return(lcd44780mcpwrite(dev,MCP17BGPIOB,buf,len));
+}
+
+const lcd44780driver lcd44780rgbplatedrv={0, lcd44780platebegin, lcd44780queuestrobes, lcd44780pcfnibble, lcd44780platelight, lcd44780platesend, NULL, NULL, 0};
+
+/* MCP backpack external library functions */
+
+int lcd44780rgb(int pi, int fd, uint8_t red, uint8_t green, uint8_t blue)
+/******************************************************************************/
+/*                                                                            */
+/* Set the backlight colour of an Adafruit RGB LCD plate (0=OFF, any other    */
+/* value = ON for each of red, green and blue). lcd44780backlight still turns */
+/* the backlight as a whole on and off.                                       */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+{
+	lcd44780dev *dev;
+
+	dev=lcd44780getdev(pi,fd,1);
+	if (dev == NULL) {
+		lcd44780error_fprintf(NOMEMORY);
+		return (NOMEMORY);
+	}
+
+	if (dev->backpack != LCD44780RGBPLATE) {
+		lcd44780error_fprintf(BADSETTING);
+		return (BADSETTING);
+	}
+
+	dev->rgb=((red) ? RGBRED : 0)|((green) ? RGBGREEN : 0)|((blue) ? RGBBLUE : 0);
+
+	return (lcd44780backlight(pi,fd,dev->blon));
+}
@@ -0,0 +1,449 @@
+/******************************************************************************/
+/*                                                                            */
+/* Mock pigpiod for the                                                       */
+/* 44780 LCD display library for I2C bus.                                     */
+/*                                                                            */
+/* Speaks enough of the pigpiod socket protocol for the library's own         */
+/* pigpiod client (lcd44780pigsopen), and for pigpiod_if2's pigpio_start and  */
+/* I2C calls, so lcd44780test and other programs can be run unchanged without */
+/* a Pi - i2c_open, i2c_close, i2c_write_device, i2c_write_byte,              */
+/* i2c_read_device, i2c_read_byte and i2c_zip.                                */
+/*                                                                            */
+/* Every I2C device is an HD44780U on a PCF8574 (see lcd44780sim.c), which    */
+/* reads are answered from. Every byte written can also be appended to a      */
+/* file, so the stream can be compared with a known good one. Each command    */
+/* can be made to take as long as it would on a Pi - a fixed time to turn it  */
+/* round, plus the time its bytes take on the I2C bus.                        */
+/*                                                                            */
+/* Usage: lcd44780mockd [-p port] [-o file] [-l us] [-b hz] [-d RxC] [-v]     */
+/*                                                                            */
+/*      -p  port to listen on (default 8888)                                  */
+/*      -o  file the I2C bytes are appended to                                */
+/*      -l  microseconds added to every command (about 100 on a Pi 3B+).      */
+/*          Commands are carried out one at a time, so the time is added to   */
+/*          each in turn - a client that pipelines its writes (as             */
+/*          lcd44780pigsopen's does) is modelled as if it waited for every    */
+/*          reply.                                                            */
+/*      -b  I2C bus clock to add the time for each transfer (e.g. 100000)     */
+/*          and check the displays' timing - any violations are reported on   */
+/*          stderr when the display is closed                                 */
+/*      -d  show each display's rows and columns (e.g. 4x20) when it's        */
+/*          closed, and all of them on SIGUSR1                                */
+/*      -v  log each command on stderr                                        */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include "lcd44780sim.h"
+
+// pigpiod socket commands
+
+#define MOCKNC                  21      // notify_close
+#define MOCKNOIB                99      // pigpio_start's notification socket
+#define MOCKI2CO                54      // i2c_open
+#define MOCKI2CC                55      // i2c_close
+#define MOCKI2CRD               56      // i2c_read_device
+#define MOCKI2CWD               57      // i2c_write_device
+#define MOCKI2CRS               59      // i2c_read_byte
+#define MOCKI2CWS               60      // i2c_write_byte
+#define MOCKI2CZ                92      // i2c_zip
+
+// pigpio error codes
+
+#define MOCKNOHANDLE            -24     // PI_NO_HANDLE
+#define MOCKBADHANDLE           -25     // PI_BAD_HANDLE
+#define MOCKBADSCRIPT           -47     // PI_BAD_SCRIPT
+#define MOCKUNSUPPORTED         -1      // Command the mock doesn't implement
+
+#define MOCKCLIENTS             16      // Connections at once
+#define MOCKHANDLES             32      // I2C handles open at once
+#define MOCKEXTMAX              65536   // Largest command extension accepted
+
+typedef struct {
+	int used;
+	unsigned bus;
+	unsigned addr;
+	lcd44780sim sim;			// The display it's wired to
+} mockhandle;
+
+typedef struct {
+	int sock;
+	uint8_t head[16];			// Command being read
+	int headlen;
+	uint8_t *ext;				// and its extension
+	uint32_t extlen;
+	uint32_t extgot;
+} mockclient;
+
+static mockhandle handles[MOCKHANDLES];
+static int outfd=-1;
+static int verbose=0;
+static uint32_t bushz=0;			// I2C bus clock, or 0 to take no time
+static uint64_t cmdns;				// Time the current command started
+static uint64_t busns;				// and the bus time it has taken
+static uint64_t latencyns=0;			// Time added to every command
+static int showrows=0, showcols=0;
+static volatile sig_atomic_t showall=0;
+
+static int mockwrite(uint32_t h, uint8_t *buf, uint32_t len) {
+/******************************************************************************/
+/*                                                                            */
+/* Write bytes to the I2C device open as handle h.                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	uint32_t i;
+
+	if ((h >= MOCKHANDLES) || (handles[h].used == 0)) return (MOCKBADHANDLE);
+	if ((outfd >= 0) && (len > 0) && (write(outfd,buf,len) != (ssize_t)len)) perror("lcd44780mockd: write");
+
+	if (bushz) busns+=9*1000000000ULL/bushz;		// Address, then each byte, 9 clocks each
+	for (i=0;i<len;i++) {
+		if (bushz) busns+=9*1000000000ULL/bushz;
+		lcd44780simwrite(&handles[h].sim,buf[i],cmdns+busns);
+	}
+	return (0);
+}
+
+static int mockread(uint32_t h, uint8_t *buf, uint32_t len) {
+/******************************************************************************/
+/*                                                                            */
+/* Read bytes from the I2C device open as handle h.                           */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	uint32_t i;
+
+	if ((h >= MOCKHANDLES) || (handles[h].used == 0)) return (MOCKBADHANDLE);
+
+	for (i=0;i<len;i++) buf[i]=lcd44780simread(&handles[h].sim);
+	if (bushz) busns+=(uint64_t)(len+1)*9*1000000000/bushz;
+	return (len);
+}
+
+static void mockshow(uint32_t h) {
+/******************************************************************************/
+/*                                                                            */
+/* Print what the display on handle h shows, if asked to with -d.             */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	if (showrows == 0) return;
+
+	printf("Handle %u (bus %u, address 0x%02x)\n",h,handles[h].bus,handles[h].addr);
+	lcd44780simshow(&handles[h].sim,stdout,showrows,showcols);
+	fflush(stdout);
+	return;
+}
+
+static void mocksignal(int sig) {
+/******************************************************************************/
+/*                                                                            */
+/* SIGUSR1 - show every display once the current command is done.             */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	(void)sig;
+	showall=1;
+	return;
+}
+
+static int mockzip(uint32_t h, uint8_t *zip, uint32_t len, uint8_t *in, int *inlen) {
+/******************************************************************************/
+/*                                                                            */
+/* Carry out an i2c_zip sequence, collecting anything read in in.             */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	uint32_t i=0,n;
+	int esc=0,op,res;
+
+	*inlen=0;
+	if ((h >= MOCKHANDLES) || (handles[h].used == 0)) return (MOCKBADHANDLE);
+
+	while ((i < len) && (zip[i] != 0)) {		// 0 - End
+		op=zip[i++];
+		switch (op) {
+		case 1:					// Escape - next count is 16 bits
+			esc=1;
+			continue;
+		case 2:					// On, Off - combined flag
+		case 3:
+			break;
+		case 4:					// Address
+			if (i+1+esc > len) return (MOCKBADSCRIPT);
+			handles[h].addr=zip[i];
+			i+=1+esc;
+			break;
+		case 5:					// Flags
+			i+=2;
+			break;
+		case 6:					// Read
+		case 7:					// Write
+			if (i+1+esc > len) return (MOCKBADSCRIPT);
+			n=esc ? zip[i]|(zip[i+1]<<8) : zip[i];
+			i+=1+esc;
+			if (op == 6) {
+				if (*inlen+n > MOCKEXTMAX) return (MOCKBADSCRIPT);
+				mockread(h,in+*inlen,n);
+				*inlen+=n;
+			}
+			else {
+				if (i+n > len) return (MOCKBADSCRIPT);
+				res=mockwrite(h,zip+i,n);
+				if (res < 0) return (res);
+				i+=n;
+			}
+			break;
+		default:
+			return (MOCKBADSCRIPT);
+		}
+		esc=0;
+	}
+	return (*inlen);
+}
+
+static void mockcommand(mockclient *c) {
+/******************************************************************************/
+/*                                                                            */
+/* Carry out the command a client has sent and reply to it.                   */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	uint32_t cmd[4],h;
+	int32_t res=0;
+	int extlen=0;
+	static uint8_t ext[MOCKEXTMAX];
+	uint8_t reply[16],byte;
+	struct timespec wait;
+
+	memcpy(cmd,c->head,sizeof(cmd));
+	clock_gettime(CLOCK_MONOTONIC,&wait);
+	cmdns=(uint64_t)wait.tv_sec*1000000000ULL+wait.tv_nsec;
+	busns=0;
+
+	switch (cmd[0]) {
+	case MOCKI2CO:
+		for (h=0;(h < MOCKHANDLES) && handles[h].used;h++);
+		if (h == MOCKHANDLES) res=MOCKNOHANDLE;
+		else {
+			handles[h].used=1;
+			handles[h].bus=cmd[1];
+			handles[h].addr=cmd[2];
+			lcd44780simreset(&handles[h].sim,NULL);
+			handles[h].sim.checking=(bushz != 0);	// Bytes only have times on a modelled bus
+			res=h;
+		}
+		break;
+	case MOCKI2CC:
+		if ((cmd[1] >= MOCKHANDLES) || (handles[cmd[1]].used == 0)) res=MOCKBADHANDLE;
+		else {
+			mockshow(cmd[1]);
+			if (handles[cmd[1]].sim.violations) {
+				fprintf(stderr,"lcd44780mockd: handle %u: ",cmd[1]);
+				lcd44780simreport(&handles[cmd[1]].sim,stderr);
+			}
+			handles[cmd[1]].used=0;
+		}
+		break;
+	case MOCKI2CWD:
+		res=mockwrite(cmd[1],c->ext,c->extlen);
+		break;
+	case MOCKI2CWS:
+		byte=cmd[2];
+		res=mockwrite(cmd[1],&byte,1);
+		break;
+	case MOCKI2CRD:
+		if (cmd[2] > MOCKEXTMAX) cmd[2]=MOCKEXTMAX;
+		res=mockread(cmd[1],ext,cmd[2]);
+		if (res > 0) extlen=res;
+		break;
+	case MOCKI2CRS:
+		res=mockread(cmd[1],&byte,1);
+		if (res > 0) res=byte;
+		break;
+	case MOCKNOIB:				// Nothing is ever notified
+	case MOCKNC:
+		break;
+	case MOCKI2CZ:
+		res=mockzip(cmd[1],c->ext,c->extlen,ext,&extlen);
+		if (res < 0) extlen=0;
+		break;
+	default:
+		res=MOCKUNSUPPORTED;
+		break;
+	}
+
+	if (verbose) fprintf(stderr,"lcd44780mockd: %d: command %u (%u, %u, %u bytes) = %d\n",
+			     c->sock,cmd[0],cmd[1],cmd[2],cmd[3],res);
+
+	busns+=latencyns;
+	if (busns > 0) {			// As long as a Pi would take
+		wait.tv_sec=busns/1000000000;
+		wait.tv_nsec=busns%1000000000;
+		while (nanosleep(&wait,&wait) != 0);
+	}
+
+	memcpy(reply,cmd,12);
+	memcpy(reply+12,&res,4);
+	if ((send(c->sock,reply,16,MSG_NOSIGNAL) != 16) ||
+	    ((extlen > 0) && (send(c->sock,ext,extlen,MSG_NOSIGNAL) != extlen))) perror("lcd44780mockd: send");
+	return;
+}
+
+static int mockclientread(mockclient *c) {
+/******************************************************************************/
+/*                                                                            */
+/* Take in whatever a client has sent, carrying out each command as it        */
+/* completes. Returns -1 when the client has gone.                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	int i;
+	uint8_t buf[4096],*p=buf;
+
+	i=read(c->sock,buf,sizeof(buf));
+	if (i <= 0) return (-1);
+
+	while (i > 0) {
+		if (c->headlen < 16) {
+			while ((i > 0) && (c->headlen < 16)) {
+				c->head[c->headlen++]=*p++;
+				i--;
+			}
+			if (c->headlen < 16) break;
+
+			memcpy(&c->extlen,c->head+12,4);
+			if (c->extlen > MOCKEXTMAX) return (-1);
+			c->extgot=0;
+		}
+
+		while ((i > 0) && (c->extgot < c->extlen)) {
+			c->ext[c->extgot++]=*p++;
+			i--;
+		}
+		if (c->extgot < c->extlen) break;
+
+		mockcommand(c);
+		c->headlen=0;
+	}
+	return (0);
+}
+
+int main(int argc, char *argv[]) {
+	int opt, port=8888, lsock, sock, one=1, count, n;
+	uint32_t h;
+	struct sockaddr_in addr;
+	struct pollfd pfd[MOCKCLIENTS+1];
+	mockclient clients[MOCKCLIENTS];
+
+	while ((opt=getopt(argc,argv,"p:o:l:b:d:v")) != -1) {
+		switch (opt) {
+		case 'p':
+			port=atoi(optarg);
+			break;
+		case 'o':
+			outfd=open(optarg,O_WRONLY|O_CREAT|O_APPEND,0644);
+			if (outfd < 0) {
+				perror(optarg);
+				exit(1);
+			}
+			break;
+		case 'l':
+			latencyns=(uint64_t)atoi(optarg)*1000;
+			break;
+		case 'b':
+			bushz=atoi(optarg);
+			break;
+		case 'd':
+			if ((sscanf(optarg,"%dx%d",&showrows,&showcols) != 2) || (showrows < 1) || (showrows > 4) ||
+			    (showcols < 1) || (showcols > 40)) {
+				fprintf(stderr,"Display size must be rows x columns, e.g. 4x20\n");
+				exit(1);
+			}
+			break;
+		case 'v':
+			verbose=1;
+			break;
+		default:
+			fprintf(stderr,"Usage: %s [-p port] [-o file] [-l us] [-b hz] [-d RxC] [-v]\n"
+				"  -l us is added to each command in turn, even for pipelined writes\n",argv[0]);
+			exit(1);
+		}
+	}
+
+	lsock=socket(AF_INET,SOCK_STREAM,0);
+	setsockopt(lsock,SOL_SOCKET,SO_REUSEADDR,&one,sizeof(one));
+	memset(&addr,0,sizeof(addr));
+	addr.sin_family=AF_INET;
+	addr.sin_port=htons(port);
+	addr.sin_addr.s_addr=htonl(INADDR_LOOPBACK);
+	if ((bind(lsock,(struct sockaddr *)&addr,sizeof(addr)) < 0) || (listen(lsock,MOCKCLIENTS) < 0)) {
+		perror("lcd44780mockd");
+		exit(1);
+	}
+	signal(SIGPIPE,SIG_IGN);
+	signal(SIGUSR1,mocksignal);
+
+	for (count=0;count<MOCKCLIENTS;count++) {
+		clients[count].sock=-1;
+		clients[count].ext=malloc(MOCKEXTMAX);
+		if (clients[count].ext == NULL) {
+			fprintf(stderr,"Out of memory\n");
+			exit(1);
+		}
+	}
+
+	for (;;) {
+		pfd[0].fd=lsock;
+		pfd[0].events=POLLIN;
+		for (count=0;count<MOCKCLIENTS;count++) {
+			pfd[count+1].fd=clients[count].sock;
+			pfd[count+1].events=POLLIN;
+		}
+		if (showall) {
+			showall=0;
+			for (h=0;h<MOCKHANDLES;h++) if (handles[h].used) mockshow(h);
+		}
+		if (poll(pfd,MOCKCLIENTS+1,-1) < 0) continue;
+
+		if (pfd[0].revents & POLLIN) {
+			sock=accept(lsock,NULL,NULL);
+			for (n=0;(n < MOCKCLIENTS) && (clients[n].sock >= 0);n++);
+			if ((sock >= 0) && (n == MOCKCLIENTS)) close(sock);
+			else if (sock >= 0) {
+				setsockopt(sock,IPPROTO_TCP,TCP_NODELAY,&one,sizeof(one));
+				clients[n].sock=sock;
+				clients[n].headlen=0;
+			}
+		}
+
+		for (count=0;count<MOCKCLIENTS;count++) {
+			if ((clients[count].sock < 0) || !(pfd[count+1].revents & (POLLIN|POLLHUP|POLLERR))) continue;
+			if (mockclientread(&clients[count]) < 0) {
+				close(clients[count].sock);
+				clients[count].sock=-1;
+			}
+		}
+	}
+	return (0);
+}
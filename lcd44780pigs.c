@@ -0,0 +1,342 @@
+/******************************************************************************/
+/*                                                                            */
+/* pigpiod socket client for the HD44780U LCD display library.                */
+/*                                                                            */
+/* pigpiod_if2's i2c_write_device waits for pigpiod's reply before returning, */
+/* so every write costs a full round trip - painful with pigpiod on another   */
+/* host. This client speaks the pigpiod socket protocol itself and doesn't    */
+/* wait: each frame goes out as an I2CWD command straight away, and replies   */
+/* are collected as they arrive. pigpiod replies in order, so each one        */
+/* belongs to the oldest write not yet replied to - an error is reported by   */
+/* lcd44780sync along with the number of the write that caused it.            */
+/*                                                                            */
+/* The client catches up with pigpiod before every delay (so the display has  */
+/* really been sent the slow instruction), at lcd44780sync and when too many  */
+/* writes are outstanding.                                                    */
+/*                                                                            */
+/* lcd44780pigsmode can send each frame as an i2c_zip sequence instead.       */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+#include "lcd44780int.h"
+#include <errno.h>
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+// pigpiod socket commands
+
+#define PIGSI2CO                54      // i2c_open
+#define PIGSI2CC                55      // i2c_close
+#define PIGSI2CWD               57      // i2c_write_device
+#define PIGSI2CZ                92      // i2c_zip
+
+#define PIGSWINDOW              64      // Writes outstanding before waiting for replies
+
+#define PIGSZIPEND              0       // i2c_zip commands
+#define PIGSZIPESC              1       // (next count is 16 bits)
+#define PIGSZIPWRITE            7
+
+/* pigpiod client internal library functions */
+
+static int lcd44780pigscmd(int sock, uint32_t cmd, uint32_t p1, uint32_t p2, uint8_t *ext, uint32_t extlen) {
+/******************************************************************************/
+/*                                                                            */
+/* Send a command - four 32 bit words (command, two parameters, the length of */
+/* any extension) followed by the extension.                                  */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	int i,total=0;
+	uint32_t req[4];
+	struct iovec iov[2];
+
+	req[0]=cmd;
+	req[1]=p1;
+	req[2]=p2;
+	req[3]=extlen;
+
+	iov[0].iov_base=req;
+	iov[0].iov_len=sizeof(req);
+	iov[1].iov_base=ext;
+	iov[1].iov_len=extlen;
+
+	while ((iov[0].iov_len > 0) || (iov[1].iov_len > 0)) {
+		i=writev(sock,(iov[0].iov_len > 0) ? iov : iov+1,(iov[0].iov_len > 0) ? 2 : 1);
+		if (i < 0) return (i);
+		total+=i;
+
+		if ((size_t)i >= iov[0].iov_len) {		// Partly sent - carry on from there
+			i-=iov[0].iov_len;
+			iov[0].iov_len=0;
+			iov[1].iov_base=(uint8_t *)iov[1].iov_base+i;
+			iov[1].iov_len-=i;
+		}
+		else {
+			iov[0].iov_base=(uint8_t *)iov[0].iov_base+i;
+			iov[0].iov_len-=i;
+		}
+	}
+	return (total);
+}
+
+static int lcd44780pigsreply(int sock, int32_t *res) {
+/******************************************************************************/
+/*                                                                            */
+/* Wait for the reply to a command sent when nothing else is outstanding -    */
+/* the command echoed back, with its result in the last word.                 */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	int i,got=0;
+	uint32_t reply[4];
+
+	while (got < (int)sizeof(reply)) {
+		i=read(sock,(uint8_t *)reply+got,sizeof(reply)-got);
+		if (i <= 0) return (-1);
+		got+=i;
+	}
+	*res=(int32_t)reply[3];
+	return (0);
+}
+
+static int lcd44780pigscollect(lcd44780dev *dev, uint32_t upto) {
+/******************************************************************************/
+/*                                                                            */
+/* Read replies until there are no more than upto writes outstanding, also    */
+/* taking in any others already waiting. The first error is kept for          */
+/* lcd44780sync, with the number of the write it belongs to.                  */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	int i;
+	int32_t res;
+	struct pollfd pfd;
+
+	pfd.fd=dev->fd;
+	pfd.events=POLLIN;
+
+	while (dev->done != dev->sent) {
+		i=poll(&pfd,1,(dev->sent-dev->done > upto) ? -1 : 0);
+		if ((i < 0) && (errno == EINTR)) continue;	// Interrupted by a signal - wait again
+		if (i <= 0) break;
+
+		i=read(dev->fd,dev->reply+dev->replylen,sizeof(dev->reply)-dev->replylen);
+		if ((i < 0) && (errno == EINTR)) continue;
+		if (i <= 0) {						// pigpiod has gone -
+			if (dev->syncerr == 0) {			// everything outstanding is lost
+				dev->syncerr=-1;
+				dev->syncerrseq=dev->done+1;
+			}
+			dev->done=dev->sent;
+			return (-1);
+		}
+
+		dev->replylen+=i;
+		if (dev->replylen == sizeof(dev->reply)) {
+			dev->replylen=0;
+			dev->done++;
+			memcpy(&res,dev->reply+12,sizeof(res));
+			if ((res < 0) && (dev->syncerr == 0)) {
+				dev->syncerr=res;
+				dev->syncerrseq=dev->done;
+			}
+		}
+	}
+	return (0);
+}
+
+static int lcd44780pigssend(lcd44780dev *dev, uint8_t *buf, int len) {
+/******************************************************************************/
+/*                                                                            */
+/* Send a frame without waiting for its reply, picking up any replies already */
+/* in, and only stopping to wait if PIGSWINDOW writes are outstanding.        */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	int i,n=0;
+	uint8_t zip[OUTSIZE+5];
+
+	lcd44780pigscollect(dev,PIGSWINDOW);	// dev->sent already counts this frame
+
+	if (dev->pigsmode == LCD44780PIGSZIP) {
+		if (len > 255) zip[n++]=PIGSZIPESC;
+		zip[n++]=PIGSZIPWRITE;
+		zip[n++]=len&0xFF;
+		if (len > 255) zip[n++]=len>>8;
+		memcpy(zip+n,buf,len);
+		n+=len;
+		zip[n++]=PIGSZIPEND;
+		i=lcd44780pigscmd(dev->fd,PIGSI2CZ,dev->handle,0,zip,n);
+	}
+	else i=lcd44780pigscmd(dev->fd,PIGSI2CWD,dev->handle,0,buf,len);
+
+	if (i < 0) {
+		dev->done++;			// Never went, so there'll be no reply
+		return (i);
+	}
+	return (0);
+}
+
+static int lcd44780pigssync(lcd44780dev *dev) {
+/******************************************************************************/
+/*                                                                            */
+/* Wait for every write to be replied to.                                     */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	return (lcd44780pigscollect(dev,0));
+}
+
+static void lcd44780pigsend(lcd44780dev *dev) {
+/******************************************************************************/
+/*                                                                            */
+/* Catch up, close the I2C handle and disconnect.                             */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	int32_t res;
+
+	lcd44780pigscollect(dev,0);
+	if (lcd44780pigscmd(dev->fd,PIGSI2CC,dev->handle,0,NULL,0) >= 0) lcd44780pigsreply(dev->fd,&res);
+	close(dev->fd);
+	return;
+}
+
+const lcd44780driver lcd44780pigsdrv={0, NULL, lcd44780queuestrobes, lcd44780pcfnibble, lcd44780pcflight, lcd44780pigssend, lcd44780pigsend, lcd44780pigssync, 0};
+
+/* pigpiod client external library functions */
+
+int lcd44780pigsopen(char *host, char *port, unsigned bus, unsigned addr)
+/******************************************************************************/
+/*                                                                            */
+/* Connect to pigpiod on host (NULL for $PIGPIO_ADDR, or localhost) and port  */
+/* (NULL for $PIGPIO_PORT, or 8888), as pigpio_start does, and open the       */
+/* display's PCF8574 backpack at I2C address addr on bus, e.g.                */
+/*                                                                            */
+/*      fd=lcd44780pigsopen("lcdpi.local",NULL,1,LCD44780ADDR);               */
+/*      lcd44780init(LCD44780NOPI,fd,4,20);                                   */
+/*                                                                            */
+/* Returns the handle to use (with pi=LCD44780NOPI) for the display,          */
+/* NOMEMORY, NODEVICE if pigpiod can't be reached, or the pigpio error code   */
+/* if pigpiod refused the I2C open.                                           */
+/* lcd44780close closes it and disconnects.                                   */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+{
+	int sock=-1,one=1;
+	int32_t res;
+	uint32_t flags=0;
+	struct addrinfo hints, *res0, *ai;
+	lcd44780dev *dev;
+
+	if (host == NULL) host=getenv("PIGPIO_ADDR");
+	if ((host == NULL) || (*host == 0)) host="localhost";
+	if (port == NULL) port=getenv("PIGPIO_PORT");
+	if ((port == NULL) || (*port == 0)) port="8888";
+
+	memset(&hints,0,sizeof(hints));
+	hints.ai_family=AF_UNSPEC;
+	hints.ai_socktype=SOCK_STREAM;
+	if (getaddrinfo(host,port,&hints,&res0) != 0) {
+		lcd44780error_fprintf(NODEVICE);
+		return (NODEVICE);
+	}
+
+	for (ai=res0;ai!=NULL;ai=ai->ai_next) {
+		sock=socket(ai->ai_family,ai->ai_socktype,ai->ai_protocol);
+		if (sock < 0) continue;
+		if (connect(sock,ai->ai_addr,ai->ai_addrlen) == 0) break;
+		close(sock);
+		sock=-1;
+	}
+	freeaddrinfo(res0);
+	if (sock < 0) {
+		lcd44780error_fprintf(NODEVICE);
+		return (NODEVICE);
+	}
+
+	setsockopt(sock,IPPROTO_TCP,TCP_NODELAY,&one,sizeof(one));	// Frames go now, not batched up
+
+	if ((lcd44780pigscmd(sock,PIGSI2CO,bus,addr,(uint8_t *)&flags,sizeof(flags)) < 0) ||
+	    (lcd44780pigsreply(sock,&res) < 0)) {
+		close(sock);
+		lcd44780error_fprintf(NODEVICE);
+		return (NODEVICE);
+	}
+	if (res < 0) {
+		close(sock);
+		return (res);
+	}
+
+	dev=lcd44780getdev(LCD44780NOPI,sock,1);
+	if (dev == NULL) {
+		close(sock);
+		lcd44780error_fprintf(NOMEMORY);
+		return (NOMEMORY);
+	}
+
+	dev->drv=&lcd44780pigsdrv;
+	dev->backpack=LCD44780PIGS;
+	dev->handle=res;
+	dev->sent=0;
+	dev->done=0;
+	dev->replylen=0;
+	dev->pigsmode=LCD44780PIGSWRITE;
+
+	return (sock);
+}
+
+int lcd44780pigsmode(int fd, uint8_t mode)
+/******************************************************************************/
+/*                                                                            */
+/* Choose how a display opened with lcd44780pigsopen is written to:           */
+/*                                                                            */
+/*      LCD44780PIGSWRITE  - each frame as one i2c_write_device (default)     */
+/*      LCD44780PIGSZIP    - each frame as one i2c_zip sequence               */
+/*                                                                            */
+/* Returns 0, or BADSETTING if fd isn't a pigpiod client display or mode      */
+/* isn't valid.                                                               */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+{
+	lcd44780dev *dev;
+
+	dev=lcd44780getdev(LCD44780NOPI,fd,0);
+	if ((dev == NULL) || (dev->backpack != LCD44780PIGS) || (mode > LCD44780PIGSZIP)) {
+		lcd44780error_fprintf(BADSETTING);
+		return (BADSETTING);
+	}
+
+	lcd44780flush(dev);			// Anything queued goes the old way
+	lcd44780pigscollect(dev,0);
+
+	dev->pigsmode=mode;
+	return (0);
+}
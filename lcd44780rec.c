@@ -0,0 +1,177 @@
+/******************************************************************************/
+/*                                                                            */
+/* Session recording for the HD44780U LCD display library for I2C bus.        */
+/*                                                                            */
+/* While a display is being recorded (lcd44780record), each call made to the  */
+/* library's higher level functions (lcd44780str, lcd44780commit, etc.) is    */
+/* written to a compact binary file with its arguments, followed by every     */
+/* write to the bus it makes and the time it took - see lcd44780rec.h for the */
+/* format. Only the outermost call is recorded; lcd44780init's own calls to   */
+/* lcd44780clear and so on are part of it. lcd44780replay plays a recording   */
+/* back through the simulator and compares the traffic.                       */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+#include "lcd44780int.h"
+#include "lcd44780rec.h"
+
+/* Recording internal library functions */
+
+static void lcd44780recvarint(FILE *f, uint64_t n) {
+/******************************************************************************/
+/*                                                                            */
+/* Write an unsigned varint.                                                  */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	while (n >= 0x80) {
+		fputc((n&0x7F)|0x80,f);
+		n>>=7;
+	}
+	fputc(n,f);
+	return;
+}
+
+static void lcd44780recsigned(FILE *f, int64_t n) {
+/******************************************************************************/
+/*                                                                            */
+/* Write a signed varint, zigzag encoded.                                     */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	lcd44780recvarint(f,((uint64_t)n<<1)^(uint64_t)(n>>63));
+	return;
+}
+
+static void lcd44780rectime(lcd44780dev *dev) {
+/******************************************************************************/
+/*                                                                            */
+/* Write the time since the last record.                                      */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	uint64_t now;
+
+	now=lcd44780clocknow();
+	lcd44780recvarint(dev->rec,(now > dev->recat) ? now-dev->recat : 0);
+	if (now > dev->recat) dev->recat=now;
+	return;
+}
+
+void lcd44780reccall(lcd44780dev *dev, uint8_t op, int nargs, int *args, char *bytes, int len) {
+/******************************************************************************/
+/*                                                                            */
+/* A call is starting - record it unless it's being made by another call      */
+/* that's already been recorded. Every lcd44780reccall must be matched by a   */
+/* lcd44780recend. len may be RECSTRING for a terminated string - it's only   */
+/* measured while recording.                                                  */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	int count;
+
+	if (dev->rec == NULL) return;
+	if (dev->recdepth++ > 0) return;
+
+	fputc(RECCALL,dev->rec);
+	fputc(op,dev->rec);
+	lcd44780rectime(dev);
+	lcd44780recvarint(dev->rec,nargs);
+	for (count=0;count<nargs;count++) lcd44780recsigned(dev->rec,args[count]);
+	if (len == RECSTRING) len=strlen(bytes);
+	lcd44780recvarint(dev->rec,len);
+	fwrite(bytes,1,len,dev->rec);
+	return;
+}
+
+void lcd44780recend(lcd44780dev *dev, int result) {
+/******************************************************************************/
+/*                                                                            */
+/* A call is returning result - record that if it's the outermost one.        */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	if ((dev->rec == NULL) || (dev->recdepth == 0)) return;
+	if (--dev->recdepth > 0) return;
+
+	fputc(RECEND,dev->rec);
+	lcd44780rectime(dev);
+	lcd44780recsigned(dev->rec,result);
+	return;
+}
+
+void lcd44780recwrite(lcd44780dev *dev, uint64_t start, uint64_t ns, int result) {
+/******************************************************************************/
+/*                                                                            */
+/* Record the queue having been written to the bus from start for ns          */
+/* nanoseconds.                                                               */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	fputc(RECWRITE,dev->rec);
+	lcd44780recvarint(dev->rec,(start > dev->recat) ? start-dev->recat : 0);
+	if (start > dev->recat) dev->recat=start;
+	lcd44780recvarint(dev->rec,ns);
+	lcd44780recsigned(dev->rec,result);
+	lcd44780recvarint(dev->rec,dev->outlen);
+	fwrite(dev->out,1,dev->outlen,dev->rec);
+	return;
+}
+
+/* Recording external library functions */
+
+int lcd44780record(int pi, int fd, FILE *f)
+/******************************************************************************/
+/*                                                                            */
+/* Start recording the display's session to f, or stop if f is NULL (f is     */
+/* flushed but not closed). Don't start in the middle of drawing with         */
+/* lcd44780draw - a replay starts with the framebuffer empty. Start before    */
+/* lcd44780init for a recording that replays exactly.                         */
+/*                                                                            */
+/* Returns 0, or NOMEMORY.                                                    */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+{
+	lcd44780dev *dev;
+
+	dev=lcd44780getdev(pi,fd,1);
+	if (dev == NULL) {
+		lcd44780error_fprintf(NOMEMORY);
+		return (NOMEMORY);
+	}
+
+	lcd44780flush(dev);			// Anything queued went before the recording
+	if (dev->rec != NULL) fflush(dev->rec);
+	dev->rec=f;
+	dev->recdepth=0;
+	if (f == NULL) return (0);
+
+	fwrite(RECMAGIC,1,strlen(RECMAGIC),f);
+	fputc(RECVERSION,f);
+	fputc(dev->rows,f);
+	fputc(dev->cols,f);
+	fputc(dev->backpack,f);
+	dev->recat=lcd44780clocknow();
+	return (0);
+}
@@ -0,0 +1,56 @@
+/******************************************************************************/
+/*                                                                            */
+/* Header file for the                                                        */
+/* HD44780U LCD display library's session recordings (lcd44780record) and     */
+/* the program that replays them (lcd44780replay).                            */
+/*                                                                            */
+/* A recording is the header, then records until the end of the file. Every   */
+/* number after the header is a varint (7 bits a byte, least significant      */
+/* first, top bit set on all but the last byte) - signed ones zigzag encoded  */
+/* first (0, -1, 1, -2 ... as 0, 1, 2, 3 ...). Times are nanoseconds on the   */
+/* library's clock since the record before.                                   */
+/*                                                                            */
+/* Header:  "LCD44780" RECVERSION rows cols backpack                          */
+/* Call:    RECCALL op time nargs args... len bytes...                        */
+/* End:     RECEND time result          (the outermost call has returned)     */
+/* Write:   RECWRITE time ns result len bytes...   (to the bus)               */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+#define RECMAGIC                "LCD44780"
+#define RECVERSION              1
+
+#define RECCALL                 1       // Record types
+#define RECEND                  2
+#define RECWRITE                3
+
+#define RECINIT                 1       // Calls recorded - args, then bytes
+#define RECSTR                  2       // row col, string
+#define RECCHR                  3       // row col, character (UTF-8)
+#define RECCLEARLINE            4       // row col
+#define RECCLEAR                5
+#define RECHOME                 6
+#define RECSETDISPLAY           7       // mode blink cursor
+#define RECBACKLIGHT            8       // setting
+#define RECDRAW                 9       // row col, string
+#define RECCOMMIT               10
+#define RECDEFCHAR              11      // slot, 8 rows
+#define RECBAR                  12      // type row col len value max
+#define RECBIGNUM               13      // row col height, string
+#define RECSETROM               14      // rom
+#define RECGLYPHBANKS           15      // setting
+#define RECSTAGECHAR            16      // glyph, 8 rows
+#define RECFLIPCHARS            17
+#define RECWRITECMD8            18      // data
+#define RECWRITECMD4            19      // data
+#define RECWRITEDATA            20      // data
+#define RECCANVASINIT           21      // row col width height
+#define RECPLOT                 22      // x y setting
+#define RECCANVASCLEAR          23
+#define RECCANVASSCROLL         24      // pixels
+#define RECCANVASCOMMIT         25
+#define RECOPS                  26
+
+#define RECARGS                 6       // Most args a call has
+#define RECSTRING               -1      // lcd44780reccall - bytes are a terminated string
@@ -0,0 +1,356 @@
+/******************************************************************************/
+/*                                                                            */
+/* Session replayer for the                                                   */
+/* 44780 LCD display library for I2C bus.                                     */
+/*                                                                            */
+/* Plays a recording made with lcd44780record back through the library as it  */
+/* is now, against the simulated display (lcd44780simopen) on the virtual     */
+/* clock, and compares the writes to the bus, the bytes written and the time  */
+/* taken for each kind of call with the recording - so a change to the        */
+/* encoders or the framebuffer planner can be checked against real sessions.  */
+/* The writes and bytes of a recording made on a PCF8574 backpack (or the     */
+/* simulator) should match exactly if nothing has changed; times only match   */
+/* recordings made on the simulator at the same bus clock.                    */
+/*                                                                            */
+/* Usage: lcd44780replay [-b hz] [-t percent] [-o file] [-s] [-v] recording   */
+/*                                                                            */
+/*      -b  simulated I2C bus clock (default 100000)                          */
+/*      -t  exit with status 2 if the replay's writes, bytes or time exceed   */
+/*          the recording's by more than percent                              */
+/*      -o  record the replay, e.g. as a new baseline                         */
+/*      -s  show the simulated display at the end                             */
+/*      -v  list each call whose writes or bytes differ                       */
+/*                                                                            */
+/* Exits with status 1 if the recording is damaged - the replay stops at the  */
+/* first record that can't be read - or has writes made outside the calls it  */
+/* records, as the replay can't follow them.                                  */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+#include "lcd44780.h"
+#include "lcd44780rec.h"
+#include "lcd44780sim.h"
+
+#define REPLAYMAXBYTES          65536   // Longest string or write in a recording
+
+typedef struct {
+	uint64_t calls;
+	uint64_t writes[2];			// Recorded (0) and replayed (1)
+	uint64_t bytes[2];
+	uint64_t ns[2];
+} replaytotals;
+
+static const char *opnames[RECOPS]={"?","init","str","chr","clearline","clear","home","setdisplay",
+				    "backlight","draw","commit","defchar","bar","bignum","setrom",
+				    "glyphbanks","stagechar","flipchars","writecmd8","writecmd4",
+				    "writedata","canvasinit","plot","canvasclear","canvasscroll",
+				    "canvascommit"};
+
+static int readvarint(FILE *f, uint64_t *n) {
+/******************************************************************************/
+/*                                                                            */
+/* Read an unsigned varint. Returns 0, or -1 at the end of the file.          */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	int c,shift=0;
+
+	*n=0;
+	do {
+		c=fgetc(f);
+		if ((c == EOF) || (shift > 63)) return (-1);
+		*n|=(uint64_t)(c&0x7F)<<shift;
+		shift+=7;
+	} while (c & 0x80);
+	return (0);
+}
+
+static int readsigned(FILE *f, int64_t *n) {
+/******************************************************************************/
+/*                                                                            */
+/* Read a zigzag encoded signed varint. Returns 0, or -1 at the end of the    */
+/* file.                                                                      */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	uint64_t u;
+
+	if (readvarint(f,&u) < 0) return (-1);
+	*n=(int64_t)(u>>1)^-(int64_t)(u&1);
+	return (0);
+}
+
+static int readbytes(FILE *f, char *buf, uint64_t *len) {
+/******************************************************************************/
+/*                                                                            */
+/* Read a length and that many bytes into buf, NUL terminated. Returns 0, or  */
+/* -1 at the end of the file or if there are too many.                        */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	if ((readvarint(f,len) < 0) || (*len >= REPLAYMAXBYTES)) return (-1);
+	if (fread(buf,1,*len,f) != *len) return (-1);
+	buf[*len]='\0';
+	return (0);
+}
+
+static int replaycall(int pi, int fd, uint8_t op, int *a, char *bytes) {
+/******************************************************************************/
+/*                                                                            */
+/* Make a recorded call again. Returns what it returns.                       */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	switch (op) {
+	case RECINIT:		return (lcd44780init(pi,fd,a[0],a[1]));
+	case RECSTR:		return (lcd44780str(pi,fd,bytes,a[0],a[1]));
+	case RECCHR:		return (lcd44780chr(pi,fd,bytes,a[0],a[1]));
+	case RECCLEARLINE:	return (lcd44780clearline(pi,fd,a[0],a[1]));
+	case RECCLEAR:		return (lcd44780clear(pi,fd));
+	case RECHOME:		return (lcd44780home(pi,fd));
+	case RECSETDISPLAY:	return (lcd44780setdisplay(pi,fd,a[0],a[1],a[2]));
+	case RECBACKLIGHT:	return (lcd44780backlight(pi,fd,a[0]));
+	case RECDRAW:		return (lcd44780draw(pi,fd,bytes,a[0],a[1]));
+	case RECCOMMIT:		return (lcd44780commit(pi,fd));
+	case RECDEFCHAR:	return (lcd44780defchar(pi,fd,a[0],(uint8_t *)bytes));
+	case RECBAR:		return (lcd44780bar(pi,fd,a[0],a[1],a[2],a[3],a[4],a[5]));
+	case RECBIGNUM:		return (lcd44780bignum(pi,fd,bytes,a[0],a[1],a[2]));
+	case RECSETROM:		return (lcd44780setrom(pi,fd,a[0]));
+	case RECGLYPHBANKS:	return (lcd44780glyphbanks(pi,fd,a[0]));
+	case RECSTAGECHAR:	return (lcd44780stagechar(pi,fd,a[0],(uint8_t *)bytes));
+	case RECFLIPCHARS:	return (lcd44780flipchars(pi,fd));
+	case RECWRITECMD8:	return (lcd44780writecmd8(pi,fd,a[0]));
+	case RECWRITECMD4:	return (lcd44780writecmd4(pi,fd,a[0]));
+	case RECWRITEDATA:	return (lcd44780writedata(pi,fd,a[0]));
+	case RECCANVASINIT:	return (lcd44780canvasinit(pi,fd,a[0],a[1],a[2],a[3]));
+	case RECPLOT:		return (lcd44780plot(pi,fd,a[0],a[1],a[2]));
+	case RECCANVASCLEAR:	return (lcd44780canvasclear(pi,fd));
+	case RECCANVASSCROLL:	return (lcd44780canvasscroll(pi,fd,a[0]));
+	case RECCANVASCOMMIT:	return (lcd44780canvascommit(pi,fd));
+	}
+	return (0);
+}
+
+static int percent(uint64_t rec, uint64_t rep, double *change) {
+/******************************************************************************/
+/*                                                                            */
+/* Change from rec to rep as a percentage. Returns 0, or -1 if rec is 0.      */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	if (rec == 0) return (-1);
+	*change=100.0*((double)rep-(double)rec)/(double)rec;
+	return (0);
+}
+
+int main(int argc, char *argv[]) {
+	int opt, fd, pi=LCD44780NOPI, show=0, verbose=0, incall=0, bad=0, count, kind, k, version;
+	int invalid=0;
+	int args[RECARGS];
+	uint32_t hz=0;
+	double limit=-1.0, change;
+	uint8_t op=0, rows, cols, backpack;
+	uint64_t n, len, ns, now=0, callat=0, outside=0, callno=0, repns;
+	int64_t s;
+	char magic[8], *bytes, *outname=NULL;
+	FILE *f, *out=NULL;
+	lcd44780counters before, after;
+	replaytotals tot[RECOPS], all, call;
+
+	while ((opt=getopt(argc,argv,"b:t:o:sv")) != -1) {
+		switch (opt) {
+		case 'b':
+			hz=atoi(optarg);
+			break;
+		case 't':
+			limit=atof(optarg);
+			break;
+		case 'o':
+			outname=optarg;
+			break;
+		case 's':
+			show=1;
+			break;
+		case 'v':
+			verbose=1;
+			break;
+		default:
+			fprintf(stderr,"Usage: %s [-b hz] [-t percent] [-o file] [-s] [-v] recording\n",argv[0]);
+			exit(1);
+		}
+	}
+	if (optind != argc-1) {
+		fprintf(stderr,"Usage: %s [-b hz] [-t percent] [-o file] [-s] [-v] recording\n",argv[0]);
+		exit(1);
+	}
+
+	f=fopen(argv[optind],"rb");
+	if (f == NULL) {
+		perror(argv[optind]);
+		exit(1);
+	}
+	if ((fread(magic,1,8,f) != 8) || (memcmp(magic,RECMAGIC,8) != 0) ||
+	    ((version=fgetc(f)) != RECVERSION)) {
+		fprintf(stderr,"%s: not a lcd44780 recording (version %d)\n",argv[optind],RECVERSION);
+		exit(1);
+	}
+	rows=fgetc(f);
+	cols=fgetc(f);
+	backpack=fgetc(f);
+	if ((backpack != LCD44780PCF8574) && (backpack != LCD44780PIGS) && (backpack != LCD44780SIM)) {
+		fprintf(stderr,"Recorded on backpack %d - writes and bytes won't compare with a PCF8574\n",backpack);
+	}
+
+	bytes=malloc(REPLAYMAXBYTES);
+	if (bytes == NULL) {
+		fprintf(stderr,"Out of memory\n");
+		exit(1);
+	}
+
+	lcd44780setclock(LCD44780CLOCKVIRTUAL);
+	fd=lcd44780simopen(hz);
+	if (fd < 0) {
+		fprintf(stderr,"Can't open the simulated display (%d)\n",fd);
+		exit(1);
+	}
+	if (rows != 0) lcd44780init(pi,fd,rows,cols);	// Recording started after lcd44780init
+
+	if (outname != NULL) {
+		out=fopen(outname,"wb");
+		if (out == NULL) {
+			perror(outname);
+			exit(1);
+		}
+		lcd44780record(pi,fd,out);
+	}
+
+	memset(tot,0,sizeof(tot));
+	memset(&call,0,sizeof(call));
+
+	while ((kind=fgetc(f)) != EOF) {
+		if (kind == RECCALL) {
+			op=fgetc(f);
+			if ((op == 0) || (op >= RECOPS) || (readvarint(f,&n) < 0)) break;
+			now+=n;
+			if ((readvarint(f,&n) < 0) || (n > RECARGS)) break;
+			memset(args,0,sizeof(args));
+			for (count=0;count<(int)n;count++) {
+				if (readsigned(f,&s) < 0) break;
+				args[count]=s;
+			}
+			if ((count < (int)n) || (readbytes(f,bytes,&len) < 0)) break;	// Not replayed
+			if (op == RECINIT) {		// Layout for -s
+				rows=args[0];
+				cols=args[1];
+			}
+
+			memset(&call,0,sizeof(call));
+			callat=now;
+			incall=1;
+			callno++;
+
+			lcd44780stats(pi,fd,&before,0);
+			repns=lcd44780clock();
+			replaycall(pi,fd,op,args,bytes);
+			call.ns[1]=lcd44780clock()-repns;
+			lcd44780stats(pi,fd,&after,0);
+			call.writes[1]=after.sends-before.sends;
+			call.bytes[1]=after.bytes-before.bytes;
+		}
+		else if (kind == RECWRITE) {
+			if ((readvarint(f,&n) < 0) || (readvarint(f,&ns) < 0) || (readsigned(f,&s) < 0)) break;
+			now+=n;
+			if (readbytes(f,bytes,&len) < 0) break;
+			if (incall) {
+				call.writes[0]++;
+				call.bytes[0]+=len;
+			}
+			else outside++;
+		}
+		else if (kind == RECEND) {
+			if ((readvarint(f,&n) < 0) || (readsigned(f,&s) < 0)) break;
+			now+=n;
+			if (!incall) continue;
+			incall=0;
+			call.ns[0]=now-callat;
+
+			tot[op].calls++;
+			for (k=0;k<2;k++) {
+				tot[op].writes[k]+=call.writes[k];
+				tot[op].bytes[k]+=call.bytes[k];
+				tot[op].ns[k]+=call.ns[k];
+			}
+			if (verbose && ((call.writes[0] != call.writes[1]) || (call.bytes[0] != call.bytes[1]))) {
+				printf("Call %llu (%s): %llu/%llu writes, %llu/%llu bytes recorded/replayed\n",
+					(unsigned long long)callno,opnames[op],
+					(unsigned long long)call.writes[0],(unsigned long long)call.writes[1],
+					(unsigned long long)call.bytes[0],(unsigned long long)call.bytes[1]);
+			}
+		}
+		else break;
+	}
+	if (kind != EOF) {			// Left the loop part way through a record
+		fprintf(stderr,"Recording is damaged after call %llu - replay stopped there\n",(unsigned long long)callno);
+		invalid=1;
+	}
+	fclose(f);
+
+	printf("%-12s %7s %17s %17s %23s\n","call","calls","writes rec/rep","bytes rec/rep","ms rec/rep");
+	memset(&all,0,sizeof(all));
+	for (op=1;op<RECOPS;op++) {
+		if (tot[op].calls == 0) continue;
+		printf("%-12s %7llu %8llu/%-8llu %8llu/%-8llu %11.3f/%-11.3f\n",opnames[op],
+			(unsigned long long)tot[op].calls,
+			(unsigned long long)tot[op].writes[0],(unsigned long long)tot[op].writes[1],
+			(unsigned long long)tot[op].bytes[0],(unsigned long long)tot[op].bytes[1],
+			tot[op].ns[0]/1e6,tot[op].ns[1]/1e6);
+		all.calls+=tot[op].calls;
+		for (k=0;k<2;k++) {
+			all.writes[k]+=tot[op].writes[k];
+			all.bytes[k]+=tot[op].bytes[k];
+			all.ns[k]+=tot[op].ns[k];
+		}
+	}
+	printf("%-12s %7llu %8llu/%-8llu %8llu/%-8llu %11.3f/%-11.3f\n","total",
+		(unsigned long long)all.calls,
+		(unsigned long long)all.writes[0],(unsigned long long)all.writes[1],
+		(unsigned long long)all.bytes[0],(unsigned long long)all.bytes[1],
+		all.ns[0]/1e6,all.ns[1]/1e6);
+
+	if (percent(all.writes[0],all.writes[1],&change) == 0) {
+		printf("Writes %+.1f%%",change);
+		if ((limit >= 0) && (change > limit)) bad=1;
+	}
+	if (percent(all.bytes[0],all.bytes[1],&change) == 0) {
+		printf(", bytes %+.1f%%",change);
+		if ((limit >= 0) && (change > limit)) bad=1;
+	}
+	if (percent(all.ns[0],all.ns[1],&change) == 0) {
+		printf(", time %+.1f%%",change);
+		if ((limit >= 0) && (change > limit)) bad=1;
+	}
+	printf("\n");
+	if (outside > 0) {			// The display was changed in a way the replay can't follow
+		printf("%llu writes made outside the calls recorded weren't replayed - the comparison isn't valid\n",
+			(unsigned long long)outside);
+		invalid=1;
+	}
+
+	if (show) lcd44780simshow(lcd44780simget(fd),stdout,(rows != 0) ? rows : 4,(cols != 0) ? cols : 20);
+
+	lcd44780close(pi,fd);
+	if (out != NULL) fclose(out);
+
+	if (invalid) exit(1);
+	if (bad) {
+		printf("Regression beyond %.1f%%\n",limit);
+		exit(2);
+	}
+	exit(0);
+}
@@ -0,0 +1,422 @@
+/******************************************************************************/
+/*                                                                            */
+/* HD44780U simulator used by the mock pigpiod (lcd44780mockd).               */
+/*                                                                            */
+/* Follows the HD44780U data sheet's instruction set and address counter      */
+/* rules, including the 8 bit interface it powers up with, so everything the  */
+/* library sends from lcd44780init on can be checked.                         */
+/*                                                                            */
+/* Each instruction or data write keeps the controller busy for the data      */
+/* sheet's execution time - SIMEXECNS for most, SIMCLEARNS for clear display  */
+/* and return home, and SIMRESET1NS and SIMRESET2NS after the first two 8 bit */
+/* function sets of initialisation by instruction. A transfer started before  */
+/* then is a timing violation, recorded with what was written, what was       */
+/* still being carried out and the shortfall. The 40ms wait after power up    */
+/* can't be checked, as the simulator doesn't know when that was.             */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+#include "lcd44780sim.h"
+#include <string.h>
+
+/* HD44780U simulator internal functions */
+
+static uint8_t lcd44780simbit(lcd44780sim *sim, int line) {
+/******************************************************************************/
+/*                                                                            */
+/* State of one of the HD44780U's lines (SIMD4 etc.) on the port.             */
+/*                                                                            */
+/* Internal function only.                                                    */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	return ((sim->port>>sim->map[line])&1);
+}
+
+static uint8_t lcd44780simdata(lcd44780sim *sim) {
+/******************************************************************************/
+/*                                                                            */
+/* The 4 bits on D4-D7.                                                       */
+/*                                                                            */
+/* Internal function only.                                                    */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	return (lcd44780simbit(sim,SIMD4)|(lcd44780simbit(sim,SIMD5)<<1)|
+		(lcd44780simbit(sim,SIMD6)<<2)|(lcd44780simbit(sim,SIMD7)<<3));
+}
+
+static void lcd44780simstep(lcd44780sim *sim, int dir) {
+/******************************************************************************/
+/*                                                                            */
+/* Move the address counter on (dir=1) or back (dir=-1) after a data read or  */
+/* write, or a cursor shift, wrapping as the HD44780U does.                   */
+/*                                                                            */
+/* Internal function only.                                                    */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	if (sim->cg) {
+		sim->ac=(sim->ac+dir)&(SIMCGRAM-1);
+		return;
+	}
+
+	if (sim->twolines) {			// 0x00-0x27 then 0x40-0x67
+		if ((dir > 0) && (sim->ac == 0x27)) sim->ac=0x40;
+		else if ((dir > 0) && (sim->ac == 0x67)) sim->ac=0x00;
+		else if ((dir < 0) && (sim->ac == 0x40)) sim->ac=0x27;
+		else if ((dir < 0) && (sim->ac == 0x00)) sim->ac=0x67;
+		else sim->ac+=dir;
+	}
+	else {					// 0x00-0x4F
+		if ((dir > 0) && (sim->ac >= 0x4F)) sim->ac=0x00;
+		else if ((dir < 0) && (sim->ac == 0x00)) sim->ac=0x4F;
+		else sim->ac+=dir;
+	}
+	return;
+}
+
+static void lcd44780simshift(lcd44780sim *sim, int dir) {
+/******************************************************************************/
+/*                                                                            */
+/* Shift the display left (dir=1) or right (dir=-1).                          */
+/*                                                                            */
+/* Internal function only.                                                    */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	int len=sim->twolines ? 40 : 80;
+
+	sim->shift=(sim->shift+dir+len)%len;
+	return;
+}
+
+static uint64_t lcd44780simexecns(lcd44780sim *sim, uint8_t rs, uint8_t data) {
+/******************************************************************************/
+/*                                                                            */
+/* How long an instruction (rs=0) or data write (rs=1) keeps the controller   */
+/* busy. Called before it's carried out.                                      */
+/*                                                                            */
+/* Internal function only.                                                    */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	if (rs) return (SIMEXECNS);
+	if ((data == 0x01) || ((data & 0xFE) == 0x02)) return (SIMCLEARNS);
+
+	if (((data & 0xF0) == 0x30) && sim->eightbit) {	// Initialising by instruction
+		if (++sim->resets == 1) return (SIMRESET1NS);
+		if (sim->resets == 2) return (SIMRESET2NS);
+	}
+	return (SIMEXECNS);
+}
+
+static void lcd44780simtiming(lcd44780sim *sim, uint8_t rs, uint8_t data) {
+/******************************************************************************/
+/*                                                                            */
+/* A write has been taken - record it if it started too soon, then the        */
+/* controller is busy with it.                                                */
+/*                                                                            */
+/* Internal function only.                                                    */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	lcd44780simviolation *v;
+
+	if (sim->early) {
+		if (sim->violations < SIMVIOLATIONS) {
+			v=&sim->violation[sim->violations];
+			v->at=sim->earlyat;
+			v->shortfall=sim->early;
+			v->rs=rs;
+			v->data=data;
+			v->busyrs=sim->busyrs;
+			v->busydata=sim->busydata;
+		}
+		sim->violations++;
+		sim->early=0;
+	}
+
+	sim->busy=sim->now+lcd44780simexecns(sim,rs,data);
+	sim->busyrs=rs;
+	sim->busydata=data;
+	return;
+}
+
+static void lcd44780siminstruction(lcd44780sim *sim, uint8_t data) {
+/******************************************************************************/
+/*                                                                            */
+/* Carry out an instruction written with RS low.                              */
+/*                                                                            */
+/* Internal function only.                                                    */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	sim->instructions++;
+
+	if (data & 0x80) {			// Set DDRAM address
+		sim->cg=0;
+		sim->ac=data&0x7F;
+	}
+	else if (data & 0x40) {			// Set CGRAM address
+		sim->cg=1;
+		sim->ac=data&0x3F;
+	}
+	else if (data & 0x20) {			// Function set
+		sim->eightbit=(data>>4)&1;
+		sim->twolines=(data>>3)&1;
+		sim->bigfont=(data>>2)&1;
+		sim->half=0;
+	}
+	else if (data & 0x10) {			// Cursor or display shift
+		if (data & 0x08) lcd44780simshift(sim,(data & 0x04) ? -1 : 1);
+		else lcd44780simstep(sim,(data & 0x04) ? 1 : -1);
+	}
+	else if (data & 0x08) {			// Display on/off control
+		sim->display=(data>>2)&1;
+		sim->cursor=(data>>1)&1;
+		sim->blink=data&1;
+	}
+	else if (data & 0x04) {			// Entry mode set
+		sim->inc=(data>>1)&1;
+		sim->autoshift=data&1;
+	}
+	else if (data & 0x02) {			// Return home
+		sim->cg=0;
+		sim->ac=0;
+		sim->shift=0;
+	}
+	else if (data & 0x01) {			// Clear display
+		memset(sim->ddram,' ',sizeof(sim->ddram));
+		sim->cg=0;
+		sim->ac=0;
+		sim->shift=0;
+		sim->inc=1;
+	}
+	return;
+}
+
+static void lcd44780simdatawrite(lcd44780sim *sim, uint8_t data) {
+/******************************************************************************/
+/*                                                                            */
+/* Write to DDRAM or CGRAM at the address counter.                            */
+/*                                                                            */
+/* Internal function only.                                                    */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	sim->writes++;
+
+	if (sim->cg) sim->cgram[sim->ac]=data;
+	else sim->ddram[sim->ac]=data;
+
+	lcd44780simstep(sim,sim->inc ? 1 : -1);
+	if (sim->autoshift && !sim->cg) lcd44780simshift(sim,sim->inc ? 1 : -1);
+	return;
+}
+
+static uint8_t lcd44780simreadbyte(lcd44780sim *sim, uint8_t rs) {
+/******************************************************************************/
+/*                                                                            */
+/* What the HD44780U puts on the bus for a read - the busy flag (always       */
+/* clear) and address counter, or the data at the address counter.            */
+/*                                                                            */
+/* Internal function only.                                                    */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	if (rs == 0) return (((sim->now < sim->busy) ? 0x80 : 0x00)|(sim->ac&0x7F));
+	return (sim->cg ? sim->cgram[sim->ac] : sim->ddram[sim->ac]);
+}
+
+/* HD44780U simulator functions */
+
+void lcd44780simreset(lcd44780sim *sim, uint8_t *map)
+/******************************************************************************/
+/*                                                                            */
+/* Power the simulated display up, wired to the port as map says (port bit    */
+/* for each of SIMD4 to SIMBL), or as the usual PCF8574 backpack if map is    */
+/* NULL. DDRAM starts full of spaces - the data sheet leaves it undefined.    */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+{
+	static uint8_t pcf8574[8]={4,5,6,7,0,1,2,3};
+
+	memset(sim,0,sizeof(*sim));
+	memcpy(sim->map,(map == NULL) ? pcf8574 : map,sizeof(sim->map));
+	memset(sim->ddram,' ',sizeof(sim->ddram));
+	sim->eightbit=1;
+	sim->inc=1;
+	sim->checking=1;
+	return;
+}
+
+void lcd44780simwrite(lcd44780sim *sim, uint8_t byte, uint64_t ns)
+/******************************************************************************/
+/*                                                                            */
+/* A byte is written to the port ns nanoseconds into the simulation (on any   */
+/* clock, as long as it never goes back). The HD44780U acts when E falls -    */
+/* taking a whole byte in 8 bit mode (D0-D3 aren't wired, so read as 0), or   */
+/* half of one in 4 bit mode.                                                 */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+{
+	uint8_t en,fell,data,rs,rw;
+
+	en=(byte>>sim->map[SIMEN])&1;
+	fell=lcd44780simbit(sim,SIMEN) && !en;
+	rs=(byte>>sim->map[SIMRS])&1;
+	rw=(byte>>sim->map[SIMRW])&1;
+
+	if (en && !lcd44780simbit(sim,SIMEN) && !rw && (sim->eightbit || (sim->half == 0)) &&
+	    sim->checking && (ns < sim->busy)) {	// Start of a write while busy
+		sim->early=sim->busy-ns;
+		sim->earlyat=ns;
+	}
+
+	sim->port=byte;
+	sim->now=ns;
+	if (!fell) return;
+
+	if (rw) {				// Read - the address counter moves after a data read
+		if (sim->eightbit || sim->readhalf) {
+			sim->readhalf=0;
+			if (rs) lcd44780simstep(sim,sim->inc ? 1 : -1);
+		}
+		else sim->readhalf=1;
+		return;
+	}
+
+	if (sim->eightbit) data=lcd44780simdata(sim)<<4;
+	else if (sim->half == 0) {
+		sim->nibble=lcd44780simdata(sim);
+		sim->half=1;
+		return;
+	}
+	else {
+		data=(sim->nibble<<4)|lcd44780simdata(sim);
+		sim->half=0;
+	}
+
+	sim->lastrs=rs;
+	sim->lastdata=data;
+	lcd44780simtiming(sim,rs,data);
+	if (rs) lcd44780simdatawrite(sim,data);
+	else lcd44780siminstruction(sim,data);
+	return;
+}
+
+uint8_t lcd44780simread(lcd44780sim *sim)
+/******************************************************************************/
+/*                                                                            */
+/* Read the port. PCF8574 lines written high are pulled low by anything       */
+/* driving them, so while RW and E are high D4-D7 show the HD44780U's output. */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+{
+	int line;
+	uint8_t value=sim->port,data;
+
+	if (!lcd44780simbit(sim,SIMRW) || !lcd44780simbit(sim,SIMEN)) return (value);
+
+	data=lcd44780simreadbyte(sim,lcd44780simbit(sim,SIMRS));
+	if (sim->eightbit || !sim->readhalf) data>>=4;	// High 4 bits, or the low 4 after them
+	data&=0x0F;
+
+	for (line=SIMD4;line<=SIMD7;line++)
+		if (((data>>(line-SIMD4))&1) == 0) value&=~(1<<sim->map[line]);
+	return (value);
+}
+
+int lcd44780simaddr(lcd44780sim *sim, int row, int col, int cols)
+/******************************************************************************/
+/*                                                                            */
+/* DDRAM address shown at row and column (counted from 0) of a display cols   */
+/* characters wide, allowing for the display shift. Rows 2 and 3 of a four    */
+/* row display carry on from rows 0 and 1.                                    */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+{
+	if (!sim->twolines) return ((row*cols+col+sim->shift)%80);
+	return (((row&1) ? 0x40 : 0x00)+((row>>1)*cols+col+sim->shift)%40);
+}
+
+void lcd44780simshow(lcd44780sim *sim, FILE *f, int rows, int cols)
+/******************************************************************************/
+/*                                                                            */
+/* Print what the display shows, in a box, with the backlight and display     */
+/* state. Characters outside printable ASCII are shown as '?', except the     */
+/* eight user defined ones which are shown as their slot number.              */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+{
+	int row,col;
+	uint8_t c;
+
+	fprintf(f,"+");
+	for (col=0;col<cols;col++) fputc('-',f);
+	fprintf(f,"+ backlight %s, display %s\n",lcd44780simbit(sim,SIMBL) ? "on" : "off",
+		sim->display ? "on" : "off");
+
+	for (row=0;row<rows;row++) {
+		fputc('|',f);
+		for (col=0;col<cols;col++) {
+			c=sim->ddram[lcd44780simaddr(sim,row,col,cols)];
+			if (c < 8) c='0'+c;
+			else if ((c < 0x20) || (c > 0x7E)) c='?';
+			fputc(sim->display ? c : ' ',f);
+		}
+		fprintf(f,"|\n");
+	}
+
+	fprintf(f,"+");
+	for (col=0;col<cols;col++) fputc('-',f);
+	fprintf(f,"+\n");
+	return;
+}
+
+uint32_t lcd44780simreport(lcd44780sim *sim, FILE *f)
+/******************************************************************************/
+/*                                                                            */
+/* Print the timing violations seen (if there have been any), returning how   */
+/* many.                                                                      */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+{
+	uint32_t count;
+	lcd44780simviolation *v;
+
+	if (sim->violations == 0) return (0);
+
+	fprintf(f,"%u timing violation%s\n",sim->violations,(sim->violations == 1) ? "" : "s");
+	for (count=0;(count < sim->violations) && (count < SIMVIOLATIONS);count++) {
+		v=&sim->violation[count];
+		fprintf(f,"  %.6f s: %s 0x%02x sent %.3f us early, while %s 0x%02x was being carried out\n",
+			v->at/1e9,v->rs ? "data" : "instruction",v->data,v->shortfall/1e3,
+			v->busyrs ? "data" : "instruction",v->busydata);
+	}
+	if (sim->violations > SIMVIOLATIONS) fprintf(f,"  (only the first %d are shown)\n",SIMVIOLATIONS);
+	return (sim->violations);
+}
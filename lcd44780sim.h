@@ -0,0 +1,96 @@
+/******************************************************************************/
+/*                                                                            */
+/* Header file for the                                                        */
+/* HD44780U simulator used by the mock pigpiod (lcd44780mockd).               */
+/*                                                                            */
+/* Models an HD44780U behind a PCF8574 - bytes written to the port are fed in */
+/* one at a time, instructions and data are taken on each fall of E, and the  */
+/* port reads back as the PCF8574's would. Every instruction keeps the        */
+/* controller busy for its execution time, and anything written before then   */
+/* is recorded as a timing violation. Doesn't need pigpiod, except for        */
+/* lcd44780simget, which is part of the library.                              */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+#include <stdio.h>
+#include <stdint.h>
+
+#define SIMD4                   0       // lcd44780sim map entries - port bit wired to
+#define SIMD5                   1
+#define SIMD6                   2
+#define SIMD7                   3
+#define SIMRS                   4
+#define SIMRW                   5
+#define SIMEN                   6
+#define SIMBL                   7
+
+#define SIMDDRAM                128     // DDRAM addresses (0x00-0x27 and 0x40-0x67 in use)
+#define SIMCGRAM                64      // CGRAM bytes
+#define SIMVIOLATIONS           16      // Timing violations kept in full
+
+#define SIMEXECNS               37000   // Execution times - most instructions and data writes
+#define SIMCLEARNS              1520000 // Clear display and return home
+#define SIMRESET1NS             4100000 // First and second 8 bit function sets after power up
+#define SIMRESET2NS             100000
+
+// Something written while the controller was still busy
+
+typedef struct {
+	uint64_t at;				// When the transfer started
+	uint64_t shortfall;			// and how much too soon
+	uint8_t rs;				// What was written
+	uint8_t data;
+	uint8_t busyrs;				// and what was still being carried out
+	uint8_t busydata;
+} lcd44780simviolation;
+
+// Simulated HD44780U and the port it's wired to
+
+typedef struct lcd44780sim {
+	uint8_t map[8];				// Port bit for D4-D7, RS, RW, E and backlight
+	uint8_t port;				// Last byte written to the port
+	uint64_t now;				// and when, in nanoseconds
+	uint8_t eightbit;			// Interface is 8 bits wide (as at power up)
+	uint8_t half;				// 4 bit mode - high nibble taken, waiting for the low one
+	uint8_t nibble;				// and what it was
+	uint8_t readhalf;			// 4 bit mode - high nibble of a read has been given
+	uint8_t twolines;			// Function set N
+	uint8_t bigfont;			// Function set F
+	uint8_t inc;				// Entry mode I/D
+	uint8_t autoshift;			// Entry mode S
+	uint8_t display;			// Display on
+	uint8_t cursor;				// Cursor on
+	uint8_t blink;				// Cursor blinking
+	uint8_t cg;				// Address counter points into CGRAM
+	uint8_t ac;				// Address counter
+	int shift;				// Display shifted left this many places
+	uint8_t ddram[SIMDDRAM];
+	uint8_t cgram[SIMCGRAM];
+	uint32_t instructions;			// Instructions and
+	uint32_t writes;			// data writes taken
+	uint8_t lastrs;				// Last instruction or data write taken
+	uint8_t lastdata;
+	uint8_t checking;			// Check timing (on unless cleared)
+	uint64_t busy;				// Time the controller is busy until
+	uint8_t busyrs;				// with this instruction or data write
+	uint8_t busydata;
+	uint8_t resets;				// 8 bit function sets since power up
+	uint64_t early;				// Transfer under way started this much too soon, or 0
+	uint64_t earlyat;			// and when
+	uint32_t violations;			// Timing violations seen
+	lcd44780simviolation violation[SIMVIOLATIONS];	// and the first SIMVIOLATIONS of them
+} lcd44780sim;
+
+/* Declare HD44780U simulator functions as externals */
+
+extern void lcd44780simreset(lcd44780sim *sim, uint8_t *map);
+extern void lcd44780simwrite(lcd44780sim *sim, uint8_t byte, uint64_t ns);
+extern uint8_t lcd44780simread(lcd44780sim *sim);
+extern int lcd44780simaddr(lcd44780sim *sim, int row, int col, int cols);
+extern void lcd44780simshow(lcd44780sim *sim, FILE *f, int rows, int cols);
+extern uint32_t lcd44780simreport(lcd44780sim *sim, FILE *f);
+
+/* Simulated display backpack, in the library (lcd44780simdev.c) */
+
+extern lcd44780sim *lcd44780simget(int fd);
@@ -0,0 +1,335 @@
+/******************************************************************************/
+/*                                                                            */
+/* Bulk strobe encoder for the HD44780U LCD display library for I2C bus.      */
+/*                                                                            */
+/* Turns a run of characters (or commands) into the four strobe bytes each    */
+/* one needs, exactly as lcd44780writedata and lcd44780writecmd4 would send   */
+/* them. Besides the table driven scalar encoder there are NEON (Raspberry    */
+/* Pi), SSE2 and AVX2 (x86) versions handling 16 or 32 characters a time,     */
+/* built for backpacks with the data lines on P4-P7 or P0-P3. The fastest one */
+/* the CPU supports for runs a display line long is chosen the first time     */
+/* it's needed - NEON or SSE2, as AVX2 only pulls ahead at 32 characters or   */
+/* more. Other wirings always use the scalar encoder.                         */
+/*                                                                            */
+/* The makefile builds this file with -O2 whatever CFLAGS says - unoptimised, */
+/* every vector encoder is slower than the scalar one.                        */
+/*                                                                            */
+/* On 32 bit Raspbian the NEON encoder is only built if the library is        */
+/* compiled with -mfpu=neon; it is always built for 64 bit ARM.               */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+#include "lcd44780int.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAVEX86
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define HAVENEON
+#if !defined(__aarch64__)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+#endif
+
+typedef void (*lcd44780encoder)(uint8_t (*table)[4], uint8_t flags, uint8_t enable, const uint8_t *src, int len, uint8_t *out);
+
+static uint8_t encoderid;				// Encoder in use (LCD44780ENCAUTO until chosen)
+
+/* Encoders. flags holds the backlight and register set bits and enable the  */
+/* enable bit for the display's wiring; table is its strobe table for the    */
+/* register being written.                                                   */
+
+static void lcd44780encodescalar(uint8_t (*table)[4], uint8_t flags, uint8_t enable, const uint8_t *src, int len, uint8_t *out) {
+/******************************************************************************/
+/*                                                                            */
+/* Table driven encoder - one 4 byte copy per character. Works for any        */
+/* wiring, and also finishes off the characters left over by the vector       */
+/* encoders.                                                                  */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	int count;
+
+	(void)flags;
+	(void)enable;
+	for (count=0;count<len;count++) {
+		memcpy(out+4*count,table[src[count]],4);
+	}
+	return;
+}
+
+/******************************************************************************/
+/*                                                                            */
+/* The vector encoders are generated for each data line layout with the       */
+/* macros below - HIGH and LOW move a character's high and low nibbles onto   */
+/* the data lines, so there's nothing to look up at run time.                 */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+
+#ifdef HAVEX86
+
+/* SSE2 - 16 characters a time. The nibbles are split out and the control    */
+/* bits ORed in, then two rounds of unpacking interleave the four strobe     */
+/* bytes of each character.                                                  */
+
+#define SSE2ENCODER(name,HIGH,LOW) \
+__attribute__((target("sse2"))) \
+static void name(uint8_t (*table)[4], uint8_t flags, uint8_t enable, const uint8_t *src, int len, uint8_t *out) { \
+	int count; \
+	__m128i ctrl=_mm_set1_epi8((char)flags); \
+	__m128i en=_mm_set1_epi8((char)enable); \
+	__m128i v,high,low,highe,lowe,a0,a1,b0,b1; \
+\
+	for (count=0;count+16<=len;count+=16) { \
+		v=_mm_loadu_si128((const __m128i *)(src+count)); \
+		high=_mm_or_si128(HIGH(v),ctrl); \
+		low=_mm_or_si128(LOW(v),ctrl); \
+		highe=_mm_or_si128(high,en); \
+		lowe=_mm_or_si128(low,en); \
+\
+		a0=_mm_unpacklo_epi8(highe,high);	/* Characters 0-7, high nibble */ \
+		a1=_mm_unpackhi_epi8(highe,high);	/* Characters 8-15 */ \
+		b0=_mm_unpacklo_epi8(lowe,low);		/* and low nibble */ \
+		b1=_mm_unpackhi_epi8(lowe,low); \
+\
+		_mm_storeu_si128((__m128i *)(out+4*count),_mm_unpacklo_epi16(a0,b0)); \
+		_mm_storeu_si128((__m128i *)(out+4*count+16),_mm_unpackhi_epi16(a0,b0)); \
+		_mm_storeu_si128((__m128i *)(out+4*count+32),_mm_unpacklo_epi16(a1,b1)); \
+		_mm_storeu_si128((__m128i *)(out+4*count+48),_mm_unpackhi_epi16(a1,b1)); \
+	} \
+\
+	lcd44780encodescalar(table,flags,enable,src+count,len-count,out+4*count); \
+}
+
+/* AVX2 - 32 characters a time. As SSE2, but unpacking works within each     */
+/* 128 bit lane, so the lanes are put back in order before storing. The      */
+/* leftovers go to the SSE2 encoder for the same layout.                     */
+
+#define AVX2ENCODER(name,sse2name,HIGH,LOW) \
+__attribute__((target("avx2"))) \
+static void name(uint8_t (*table)[4], uint8_t flags, uint8_t enable, const uint8_t *src, int len, uint8_t *out) { \
+	int count; \
+	__m256i ctrl=_mm256_set1_epi8((char)flags); \
+	__m256i en=_mm256_set1_epi8((char)enable); \
+	__m256i v,high,low,highe,lowe,a0,a1,b0,b1,o0,o1,o2,o3; \
+\
+	for (count=0;count+32<=len;count+=32) { \
+		v=_mm256_loadu_si256((const __m256i *)(src+count)); \
+		high=_mm256_or_si256(HIGH(v),ctrl); \
+		low=_mm256_or_si256(LOW(v),ctrl); \
+		highe=_mm256_or_si256(high,en); \
+		lowe=_mm256_or_si256(low,en); \
+\
+		a0=_mm256_unpacklo_epi8(highe,high);	/* Characters 0-7 and 16-23 */ \
+		a1=_mm256_unpackhi_epi8(highe,high);	/* Characters 8-15 and 24-31 */ \
+		b0=_mm256_unpacklo_epi8(lowe,low); \
+		b1=_mm256_unpackhi_epi8(lowe,low); \
+\
+		o0=_mm256_unpacklo_epi16(a0,b0);	/* 0-3 and 16-19 */ \
+		o1=_mm256_unpackhi_epi16(a0,b0);	/* 4-7 and 20-23 */ \
+		o2=_mm256_unpacklo_epi16(a1,b1);	/* 8-11 and 24-27 */ \
+		o3=_mm256_unpackhi_epi16(a1,b1);	/* 12-15 and 28-31 */ \
+\
+		_mm256_storeu_si256((__m256i *)(out+4*count),_mm256_permute2x128_si256(o0,o1,0x20)); \
+		_mm256_storeu_si256((__m256i *)(out+4*count+32),_mm256_permute2x128_si256(o2,o3,0x20)); \
+		_mm256_storeu_si256((__m256i *)(out+4*count+64),_mm256_permute2x128_si256(o0,o1,0x31)); \
+		_mm256_storeu_si256((__m256i *)(out+4*count+96),_mm256_permute2x128_si256(o2,o3,0x31)); \
+	} \
+\
+	_mm256_zeroupper();			/* No AVX to SSE transition penalty */ \
+	sse2name(table,flags,enable,src+count,len-count,out+4*count); \
+}
+
+#define SSE2HIGHP4(v)	_mm_and_si128(v,_mm_set1_epi8((char)0xF0))
+#define SSE2LOWP4(v)	_mm_and_si128(_mm_slli_epi16(v,4),_mm_set1_epi8((char)0xF0))
+#define SSE2HIGHP0(v)	_mm_and_si128(_mm_srli_epi16(v,4),_mm_set1_epi8(0x0F))
+#define SSE2LOWP0(v)	_mm_and_si128(v,_mm_set1_epi8(0x0F))
+#define AVX2HIGHP4(v)	_mm256_and_si256(v,_mm256_set1_epi8((char)0xF0))
+#define AVX2LOWP4(v)	_mm256_and_si256(_mm256_slli_epi16(v,4),_mm256_set1_epi8((char)0xF0))
+#define AVX2HIGHP0(v)	_mm256_and_si256(_mm256_srli_epi16(v,4),_mm256_set1_epi8(0x0F))
+#define AVX2LOWP0(v)	_mm256_and_si256(v,_mm256_set1_epi8(0x0F))
+
+SSE2ENCODER(lcd44780encodesse2p4,SSE2HIGHP4,SSE2LOWP4)
+SSE2ENCODER(lcd44780encodesse2p0,SSE2HIGHP0,SSE2LOWP0)
+AVX2ENCODER(lcd44780encodeavx2p4,lcd44780encodesse2p4,AVX2HIGHP4,AVX2LOWP4)
+AVX2ENCODER(lcd44780encodeavx2p0,lcd44780encodesse2p0,AVX2HIGHP0,AVX2LOWP0)
+
+#define SSE2P4		lcd44780encodesse2p4
+#define SSE2P0		lcd44780encodesse2p0
+#define AVX2P4		lcd44780encodeavx2p4
+#define AVX2P0		lcd44780encodeavx2p0
+#else
+#define SSE2P4		NULL
+#define SSE2P0		NULL
+#define AVX2P4		NULL
+#define AVX2P0		NULL
+#endif
+
+#ifdef HAVENEON
+
+/* NEON - 16 characters a time. The interleaving store (vst4q) puts the four */
+/* strobe bytes of each character in order for us.                           */
+
+#define NEONENCODER(name,HIGH,LOW) \
+static void name(uint8_t (*table)[4], uint8_t flags, uint8_t enable, const uint8_t *src, int len, uint8_t *out) { \
+	int count; \
+	uint8x16_t ctrl=vdupq_n_u8(flags); \
+	uint8x16_t en=vdupq_n_u8(enable); \
+	uint8x16_t v; \
+	uint8x16x4_t strobes; \
+\
+	for (count=0;count+16<=len;count+=16) { \
+		v=vld1q_u8(src+count); \
+		strobes.val[1]=vorrq_u8(HIGH(v),ctrl); \
+		strobes.val[3]=vorrq_u8(LOW(v),ctrl); \
+		strobes.val[0]=vorrq_u8(strobes.val[1],en); \
+		strobes.val[2]=vorrq_u8(strobes.val[3],en); \
+		vst4q_u8(out+4*count,strobes); \
+	} \
+\
+	lcd44780encodescalar(table,flags,enable,src+count,len-count,out+4*count); \
+}
+
+#define NEONHIGHP4(v)	vandq_u8(v,vdupq_n_u8(0xF0))
+#define NEONLOWP4(v)	vshlq_n_u8(v,4)
+#define NEONHIGHP0(v)	vshrq_n_u8(v,4)
+#define NEONLOWP0(v)	vandq_u8(v,vdupq_n_u8(0x0F))
+
+NEONENCODER(lcd44780encodeneonp4,NEONHIGHP4,NEONLOWP4)
+NEONENCODER(lcd44780encodeneonp0,NEONHIGHP0,NEONLOWP0)
+
+#define NEONP4		lcd44780encodeneonp4
+#define NEONP0		lcd44780encodeneonp0
+#else
+#define NEONP4		NULL
+#define NEONP0		NULL
+#endif
+
+// Encoder for each data line layout and encoder choice
+
+static lcd44780encoder encoders[LAYOUTS][LCD44780ENCNEON+1]={
+	{NULL, lcd44780encodescalar, SSE2P4, AVX2P4, NEONP4},			// LAYOUTHIGH
+	{NULL, lcd44780encodescalar, SSE2P0, AVX2P0, NEONP0},			// LAYOUTLOW
+	{NULL, lcd44780encodescalar, lcd44780encodescalar, lcd44780encodescalar, lcd44780encodescalar}	// LAYOUTOTHER
+};
+
+static int lcd44780canencode(uint8_t id) {
+/******************************************************************************/
+/*                                                                            */
+/* Returns 1 if this CPU (and build) can run encoder id, otherwise 0.         */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	switch (id) {
+		case LCD44780ENCSCALAR:
+			return(1);
+#ifdef HAVEX86
+		case LCD44780ENCSSE2:
+			__builtin_cpu_init();
+			return(__builtin_cpu_supports("sse2") ? 1 : 0);
+		case LCD44780ENCAVX2:
+			__builtin_cpu_init();
+			return(__builtin_cpu_supports("avx2") ? 1 : 0);
+#endif
+#ifdef HAVENEON
+		case LCD44780ENCNEON:
+#if defined(__aarch64__)
+			return(1);
+#else
+			return((getauxval(AT_HWCAP) & HWCAP_NEON) ? 1 : 0);
+#endif
+#endif
+	}
+	return(0);
+}
+
+/* Bulk encoder internal library functions */
+
+void lcd44780encodebytes(lcd44780dev *dev, uint8_t rs, uint8_t *src, int len, uint8_t *out) {
+/******************************************************************************/
+/*                                                                            */
+/* Encode len bytes for the command (rs=0) or data (rs=1) register into out,  */
+/* which must have room for 4*len bytes.                                      */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	if (encoderid == LCD44780ENCAUTO) lcd44780setencoder(LCD44780ENCAUTO);
+
+	encoders[dev->layout][encoderid](dev->strobes[rs],dev->bl|((rs) ? dev->rsbit : 0x00),dev->enbit,src,len,out);
+	return;
+}
+
+/* Bulk encoder external library functions */
+
+int lcd44780setencoder(uint8_t id)
+/******************************************************************************/
+/*                                                                            */
+/* Choose the strobe encoder used for every display: LCD44780ENCAUTO (the     */
+/* fastest available for short runs - NEON, else SSE2, else scalar - which is */
+/* what's used if this is never called), LCD44780ENCSCALAR, LCD44780ENCSSE2,  */
+/* LCD44780ENCAVX2 or LCD44780ENCNEON.                                        */
+/* All produce exactly the same bytes.                                        */
+/*                                                                            */
+/* Returns the encoder now in use, or BADSETTING if the one asked for can't   */
+/* run here (the encoder in use is then left alone).                          */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+{
+	if (id == LCD44780ENCAUTO) {
+		if (lcd44780canencode(LCD44780ENCNEON)) id=LCD44780ENCNEON;
+		else if (lcd44780canencode(LCD44780ENCSSE2)) id=LCD44780ENCSSE2;
+		else id=LCD44780ENCSCALAR;
+	}
+	else if (lcd44780canencode(id) == 0) return (BADSETTING);
+
+	encoderid=id;
+	return (encoderid);
+}
+
+int lcd44780encode(int pi, int fd, uint8_t rs, char *src, int len, uint8_t *out)
+/******************************************************************************/
+/*                                                                            */
+/* Encode len bytes for the command (rs=0) or data (rs=any other value)       */
+/* register of a display into out, without sending them - e.g. to build up    */
+/* frames for many displays at once. out must have room for 4*len bytes.      */
+/* The bytes are exactly those lcd44780writecmd4 or lcd44780writedata would   */
+/* send with the display's current backlight setting, on a backpack driving   */
+/* the display in 4 bit mode (any but LCD44780MCP23017) - less the idle bytes */
+/* added on a fast I2C bus (see lcd44780setbusclock).                         */
+/*                                                                            */
+/* Returns the number of bytes placed in out.                                 */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+{
+	lcd44780dev *dev;
+
+	dev=lcd44780getdev(pi,fd,1);
+	if (dev == NULL) {
+		lcd44780error_fprintf(NOMEMORY);
+		return (NOMEMORY);
+	}
+
+	lcd44780encodebytes(dev,(rs == 0) ? 0 : 1,(uint8_t *)src,len,out);
+
+	return (4*len);
+}
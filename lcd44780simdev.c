@@ -0,0 +1,180 @@
+/******************************************************************************/
+/*                                                                            */
+/* Simulated display backend for the HD44780U LCD display library.            */
+/*                                                                            */
+/* The bytes a PCF8574 backpack would be sent go straight into an HD44780U    */
+/* simulator (lcd44780sim.c) in the same process, each one stamped with the   */
+/* time it would reach the port on an I2C bus running at the rate given to    */
+/* lcd44780simopen. Writes take that long on the library's clock, so with the */
+/* virtual clock (lcd44780setclock) whole sessions run in a moment while the  */
+/* simulator still sees the real spacing.                                     */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+#include "lcd44780int.h"
+#include "lcd44780sim.h"
+#include <fcntl.h>
+
+#define SIMBUSHZ                100000  // Default I2C bus clock
+#define SIMBYTECLOCKS           9       // Clocks per I2C byte, with the acknowledge
+
+/* Simulated display internal library functions */
+
+static int lcd44780simbegin(lcd44780dev *dev) {
+/******************************************************************************/
+/*                                                                            */
+/* Wire the simulator up as the backpack is (see lcd44780setpins).            */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	dev->sim->map[SIMD4]=dev->pins.d4;
+	dev->sim->map[SIMD5]=dev->pins.d5;
+	dev->sim->map[SIMD6]=dev->pins.d6;
+	dev->sim->map[SIMD7]=dev->pins.d7;
+	dev->sim->map[SIMRS]=dev->pins.rs;
+	dev->sim->map[SIMRW]=dev->pins.rw;
+	dev->sim->map[SIMEN]=dev->pins.en;
+	dev->sim->map[SIMBL]=dev->pins.bl;
+	return (0);
+}
+
+static int lcd44780simsend(lcd44780dev *dev, uint8_t *buf, int len) {
+/******************************************************************************/
+/*                                                                            */
+/* Clock a frame into the simulator - the address, then each byte, once the   */
+/* bus is free and the write's overhead (lcd44780simoverhead) has passed -    */
+/* and wait for it to finish as i2c_write_device would.                       */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	int count;
+	uint64_t t,now,bytens;
+
+	bytens=SIMBYTECLOCKS*1000000000ULL/dev->hz;
+
+	now=lcd44780clocknow();
+	t=(dev->busfree > now) ? dev->busfree : now;
+	t+=dev->overhead+bytens;
+
+	for (count=0;count<len;count++) {
+		t+=bytens;
+		lcd44780simwrite(dev->sim,buf[count],t);
+	}
+	dev->busfree=t;
+
+	if (t > now) lcd44780clocksleep(t-now);
+	return (0);
+}
+
+static void lcd44780simend(lcd44780dev *dev) {
+/******************************************************************************/
+/*                                                                            */
+/* Throw the simulator away.                                                  */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	free(dev->sim);
+	dev->sim=NULL;
+	close(dev->fd);
+	return;
+}
+
+const lcd44780driver lcd44780simdrv={0, lcd44780simbegin, lcd44780queuestrobes, lcd44780pcfnibble, lcd44780pcflight, lcd44780simsend, lcd44780simend, NULL, 0};
+
+/* Simulated display external library functions */
+
+int lcd44780simopen(uint32_t hz)
+/******************************************************************************/
+/*                                                                            */
+/* Open a simulated display behind a PCF8574 on an I2C bus clocked at hz (0   */
+/* for 100kHz), e.g. to run a program without hardware under the virtual      */
+/* clock:                                                                     */
+/*                                                                            */
+/*      lcd44780setclock(LCD44780CLOCKVIRTUAL);                               */
+/*      fd=lcd44780simopen(0);                                                */
+/*      lcd44780init(LCD44780NOPI,fd,4,20);                                   */
+/*                                                                            */
+/* lcd44780simget gives the simulator's state. Returns the handle to use      */
+/* (with pi=LCD44780NOPI), or a negative value if it can't be set up.         */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+{
+	int fd;
+	lcd44780dev *dev;
+
+	fd=open("/dev/null",O_WRONLY);		// Just for a handle no other display has
+	if (fd < 0) return (fd);
+
+	dev=lcd44780getdev(LCD44780NOPI,fd,1);
+	if (dev != NULL) dev->sim=malloc(sizeof(lcd44780sim));
+	if ((dev == NULL) || (dev->sim == NULL)) {
+		close(fd);
+		lcd44780error_fprintf(NOMEMORY);
+		return (NOMEMORY);
+	}
+
+	lcd44780simreset(dev->sim,NULL);
+	dev->drv=&lcd44780simdrv;
+	dev->backpack=LCD44780SIM;
+	dev->hz=(hz == 0) ? SIMBUSHZ : hz;
+	dev->busfree=0;
+	dev->overhead=0;
+	dev->pad=lcd44780buspad(dev->hz);
+
+	return (fd);
+}
+
+int lcd44780simoverhead(int fd, uint32_t ns)
+/******************************************************************************/
+/*                                                                            */
+/* Make every write to a simulated display take ns nanoseconds longer before  */
+/* its bytes reach the bus - e.g. about 100000 for the round trip to pigpiod  */
+/* on a Pi 3B+, to model its cost rather than just the bus's.                 */
+/*                                                                            */
+/* Returns 0, or BADSETTING if fd isn't a simulated display.                  */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+{
+	lcd44780dev *dev;
+
+	dev=lcd44780getdev(LCD44780NOPI,fd,0);
+	if ((dev == NULL) || (dev->backpack != LCD44780SIM)) {
+		lcd44780error_fprintf(BADSETTING);
+		return (BADSETTING);
+	}
+
+	dev->overhead=ns;
+	return (0);
+}
+
+lcd44780sim *lcd44780simget(int fd)
+/******************************************************************************/
+/*                                                                            */
+/* The simulator behind a display opened with lcd44780simopen, e.g. to show   */
+/* or check what it displays - or NULL if fd isn't one.                       */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+{
+	lcd44780dev *dev;
+
+	dev=lcd44780getdev(LCD44780NOPI,fd,0);
+	if ((dev == NULL) || (dev->backpack != LCD44780SIM)) return (NULL);
+
+	return (dev->sim);
+}
@@ -0,0 +1,137 @@
+/******************************************************************************/
+/*                                                                            */
+/* Simulator test program for the                                             */
+/* 44780 LCD display library for I2C bus.                                     */
+/*                                                                            */
+/* Drives the simulated display (lcd44780simopen) on the virtual clock and    */
+/* checks what the simulated HD44780U shows after each step - the glyph bank  */
+/* calls (lcd44780glyphbanks, stagechar and flipchars), on their own and with */
+/* draws that haven't been committed yet. No display (or pigpiod) is needed.  */
+/*                                                                            */
+/* Usage: lcd44780simtest                                                     */
+/*                                                                            */
+/* Returns 0 if every check passed, 1 if not.                                 */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+#include "lcd44780.h"
+#include "lcd44780sim.h"
+
+#define TESTROWS                4       // Display used for every check
+#define TESTCOLS                20
+
+static int failed;
+
+static uint8_t frames[5][8]={			// Frames of glyph 0, one per flip
+	{0x04,0x04,0x04,0x04,0x04,0x04,0x04,0x00},
+	{0x00,0x02,0x04,0x08,0x10,0x00,0x00,0x00},
+	{0x00,0x00,0x00,0x1F,0x00,0x00,0x00,0x00},
+	{0x10,0x08,0x04,0x02,0x01,0x00,0x00,0x00},
+	{0x1F,0x11,0x11,0x11,0x11,0x11,0x1F,0x00},
+};
+
+static int shown(lcd44780sim *sim, int row, int col, int c, uint8_t *glyph) {
+/******************************************************************************/
+/*                                                                            */
+/* Whether the cell at row and col (counted from 1) shows character c, or     */
+/* if glyph isn't NULL, a user defined character with glyph's rows.           */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	int row8;
+	uint8_t code;
+
+	code=sim->ddram[lcd44780simaddr(sim,row-1,col-1,TESTCOLS)];
+	if (glyph == NULL) return (code == c);
+	if (code >= 0x10) return (0);
+
+	for (row8=0;row8<8;row8++) {
+		if ((sim->cgram[(code&0x07)*8+row8]&0x1F) != glyph[row8]) return (0);
+	}
+	return (1);
+}
+
+static void check(char *what, int ok) {
+/******************************************************************************/
+/*                                                                            */
+/* Report a check, remembering any that fail.                                 */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	printf("%-60s %s\n",what,(ok) ? "ok" : "FAILED");
+	if (!ok) failed=1;
+	return;
+}
+
+int main(int argc, char *argv[]) {
+	int pi=LCD44780NOPI, fd;
+	lcd44780sim *sim;
+
+	if (argc > 1) {
+		fprintf(stderr,"Usage: %s\n",argv[0]);
+		exit(1);
+	}
+
+	lcd44780setclock(LCD44780CLOCKVIRTUAL);
+
+	fd=lcd44780simopen(0);
+	if (fd < 0) {
+		fprintf(stderr,"Can't open the simulated display\n");
+		exit(1);
+	}
+	sim=lcd44780simget(fd);
+	lcd44780init(pi,fd,TESTROWS,TESTCOLS);
+
+	// Character codes 0x00-0x0F name glyph (code modulo 4) once banks are on
+
+	check("glyphbanks on",lcd44780glyphbanks(pi,fd,1) == 0);
+	check("stagechar and flipchars, first frame",(lcd44780stagechar(pi,fd,0,frames[0]) == 0) &&
+		(lcd44780flipchars(pi,fd) == 0));
+	lcd44780str(pi,fd,"\x04",1,1);
+	lcd44780str(pi,fd,"\x04",2,1);
+	check("str of glyph 0 shows its frame",shown(sim,1,1,0,frames[0]) && shown(sim,2,1,0,frames[0]));
+
+	lcd44780stagechar(pi,fd,0,frames[1]);
+	check("staged frame isn't shown before the flip",shown(sim,1,1,0,frames[0]));
+	lcd44780flipchars(pi,fd);
+	check("flipchars shows the staged frame",shown(sim,1,1,0,frames[1]) && shown(sim,2,1,0,frames[1]));
+
+	// A pending draw over a glyph cell is kept, and the cell animates until the commit
+
+	lcd44780draw(pi,fd,"X",2,1);
+	lcd44780stagechar(pi,fd,0,frames[2]);
+	lcd44780flipchars(pi,fd);
+	check("glyph cell with a pending draw shows the new frame",shown(sim,2,1,0,frames[2]));
+	lcd44780commit(pi,fd);
+	check("pending draw over a glyph cell is shown on commit",shown(sim,2,1,'X',NULL));
+
+	// A pending draw of the glyph follows it to the new slot
+
+	lcd44780draw(pi,fd,"\x04",3,1);
+	lcd44780stagechar(pi,fd,0,frames[3]);
+	lcd44780flipchars(pi,fd);
+	check("pending draw of a glyph isn't sent by flipchars",shown(sim,3,1,' ',NULL));
+	lcd44780commit(pi,fd);
+	check("pending draw of a glyph shows the new frame on commit",shown(sim,3,1,0,frames[3]) &&
+		shown(sim,1,1,0,frames[3]));
+
+	// Nothing else pending is sent by a flip
+
+	lcd44780draw(pi,fd,"Y",4,1);
+	lcd44780stagechar(pi,fd,0,frames[4]);
+	lcd44780flipchars(pi,fd);
+	check("flipchars leaves other pending draws alone",shown(sim,4,1,' ',NULL) &&
+		shown(sim,1,1,0,frames[4]) && shown(sim,3,1,0,frames[4]));
+	lcd44780commit(pi,fd);
+	check("other pending draws are shown on commit",shown(sim,4,1,'Y',NULL));
+
+	check("glyphbanks off",lcd44780glyphbanks(pi,fd,0) == 0);
+	check("stagechar with banks off is refused",lcd44780stagechar(pi,fd,0,frames[0]) < 0);
+	check("no timing violations",sim->violations == 0);
+
+	lcd44780close(pi,fd);
+	exit(failed);
+}
@@ -0,0 +1,231 @@
+/******************************************************************************/
+/*                                                                            */
+/* SPI 74HC595 shift register backpack driver for the HD44780U LCD display    */
+/* library, using the Linux spidev interface - no pigpiod needed.             */
+/*                                                                            */
+/* The 74HC595's outputs take the place of the PCF8574's pins (the usual      */
+/* PCF8574 wiring is assumed - see lcd44780setpins), with its latch clock on  */
+/* chip select. Each strobe byte is shifted out as its own transfer, chip     */
+/* select rising between them to latch it, and a whole frame goes to the      */
+/* kernel as one SPI_IOC_MESSAGE.                                             */
+/*                                                                            */
+/* SPI is fast enough to outrun the HD44780U, so the transfer ending each     */
+/* instruction is followed by a pause long enough for it to execute.          */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+#include "lcd44780int.h"
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <linux/spi/spidev.h>
+
+#define SPIMAXXFERS             511     // Transfers in one SPI_IOC_MESSAGE (its size has to fit in 14 bits)
+#define SPIEXECUS               40      // Pause after an instruction, microseconds (37 in the datasheet)
+#define SPIRECORD               10      // Mock - bytes recorded for each transfer
+
+/* SPI backpack internal library functions */
+
+static void lcd44780spinibble(lcd44780dev *dev, uint8_t data) {
+/******************************************************************************/
+/*                                                                            */
+/* An 8 bit mode instruction is a single enable pulse, so make sure the       */
+/* pause follows it.                                                          */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	lcd44780flush(dev);
+	dev->phase=1;
+	lcd44780pcfnibble(dev,data);
+	return;
+}
+
+static int lcd44780spimessage(lcd44780dev *dev, struct spi_ioc_transfer *xfer, int n) {
+/******************************************************************************/
+/*                                                                            */
+/* Hand n transfers to spidev as one message. A mock display records each     */
+/* transfer in its file instead, with a single write for the message.         */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	int count,size;
+	uint8_t record[SPIMAXXFERS*SPIRECORD], *r;
+
+	if (dev->mock == 0) return(ioctl(dev->fd,SPI_IOC_MESSAGE(n),xfer));
+
+	for (count=0;count<n;count++) {
+		r=&record[count*SPIRECORD];
+		r[0]=*(uint8_t *)(unsigned long)xfer[count].tx_buf;
+		r[1]=xfer[count].len;
+		r[2]=xfer[count].bits_per_word;
+		r[3]=xfer[count].cs_change;
+		r[4]=xfer[count].delay_usecs&0xFF;		// Little endian
+		r[5]=xfer[count].delay_usecs>>8;
+		r[6]=xfer[count].speed_hz&0xFF;
+		r[7]=(xfer[count].speed_hz>>8)&0xFF;
+		r[8]=(xfer[count].speed_hz>>16)&0xFF;
+		r[9]=xfer[count].speed_hz>>24;
+	}
+
+	size=n*SPIRECORD;
+	return((write(dev->fd,record,size) == size) ? 0 : -1);
+}
+
+static int lcd44780spisend(lcd44780dev *dev, uint8_t *buf, int len) {
+/******************************************************************************/
+/*                                                                            */
+/* Send the queued bytes as one SPI message of single byte transfers. Every   */
+/* second time enable falls, an instruction is complete and gets its pause.   */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	int i=0,count,n;
+	struct spi_ioc_transfer xfer[SPIMAXXFERS];
+
+	while ((len > 0) && (i >= 0)) {
+		n=(len > SPIMAXXFERS) ? SPIMAXXFERS : len;
+
+		memset(xfer,0,n*sizeof(struct spi_ioc_transfer));
+		for (count=0;count<n;count++) {
+			xfer[count].tx_buf=(unsigned long)(buf+count);
+			xfer[count].len=1;
+			xfer[count].speed_hz=dev->hz;
+			xfer[count].bits_per_word=8;
+			xfer[count].cs_change=(count < n-1) ? 1 : 0;	// Latch each byte
+
+			if ((dev->last & dev->enbit) && ((buf[count] & dev->enbit) == 0)) {
+				if (++dev->phase == 2) {
+					xfer[count].delay_usecs=SPIEXECUS;
+					dev->phase=0;
+				}
+			}
+			dev->last=buf[count];
+		}
+		i=lcd44780spimessage(dev,xfer,n);
+
+		buf+=n;
+		len-=n;
+	}
+
+	return((i < 0) ? i : 0);
+}
+
+static void lcd44780spiend(lcd44780dev *dev) {
+/******************************************************************************/
+/*                                                                            */
+/* Close the spidev device (or the mock's copy of its file).                  */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	close(dev->fd);
+	return;
+}
+
+const lcd44780driver lcd44780spi595drv={0, NULL, lcd44780queuestrobes, lcd44780spinibble, lcd44780pcflight, lcd44780spisend, lcd44780spiend, NULL, 0};
+
+static int lcd44780spiattach(int fd, uint32_t hz, uint8_t mock) {
+/******************************************************************************/
+/*                                                                            */
+/* Set up the library's state for a newly opened SPI display.                 */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	lcd44780dev *dev;
+
+	dev=lcd44780getdev(LCD44780NOPI,fd,1);
+	if (dev == NULL) {
+		close(fd);
+		lcd44780error_fprintf(NOMEMORY);
+		return (NOMEMORY);
+	}
+
+	dev->drv=&lcd44780spi595drv;
+	dev->backpack=LCD44780SPI595;
+	dev->hz=hz;
+	dev->mock=mock;
+	dev->phase=0;
+	dev->last=0x00;
+
+	return (fd);
+}
+
+/* SPI backpack external library functions */
+
+int lcd44780spiopen(char *device, uint32_t hz)
+/******************************************************************************/
+/*                                                                            */
+/* Open a display on a 74HC595 SPI backpack, e.g.                             */
+/*                                                                            */
+/*      fd=lcd44780spiopen("/dev/spidev0.0",4000000);                         */
+/*      lcd44780init(LCD44780NOPI,fd,4,20);                                   */
+/*                                                                            */
+/* Returns the handle to use (with pi=LCD44780NOPI) for the display,          */
+/* NOMEMORY, or NODEVICE if spidev can't be opened and set up (SPI mode 0, 8  */
+/* bits). lcd44780close closes it again.                                      */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+{
+	int fd;
+	uint8_t mode=SPI_MODE_0, bits=8;
+
+	fd=open(device,O_RDWR);
+	if (fd < 0) {
+		lcd44780error_fprintf(NODEVICE);
+		return (NODEVICE);
+	}
+
+	if ((ioctl(fd,SPI_IOC_WR_MODE,&mode) < 0) ||
+	    (ioctl(fd,SPI_IOC_WR_BITS_PER_WORD,&bits) < 0) ||
+	    (ioctl(fd,SPI_IOC_WR_MAX_SPEED_HZ,&hz) < 0)) {
+		close(fd);
+		lcd44780error_fprintf(NODEVICE);
+		return (NODEVICE);
+	}
+
+	return (lcd44780spiattach(fd,hz,0));
+}
+
+int lcd44780spimock(int fd)
+/******************************************************************************/
+/*                                                                            */
+/* Open a mock SPI display for testing without hardware. Instead of going to  */
+/* spidev, each SPI message is written to fd (a file, pipe or socket) with a  */
+/* single write, as 10 bytes for each of its transfers: the byte sent (the    */
+/* same one a PCF8574 backpack would be sent), then the transfer's len,       */
+/* bits_per_word and cs_change, its delay_usecs (16 bits) and speed_hz (32    */
+/* bits), both little endian. The mock's speed_hz is 0 (spidev's default).    */
+/*                                                                            */
+/* Returns the handle to use (with pi=LCD44780NOPI), NOMEMORY, or NODEVICE    */
+/* if fd can't be used. fd itself is left open by lcd44780close.              */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+{
+	int copy;
+
+	copy=dup(fd);
+	if (copy < 0) {
+		lcd44780error_fprintf(NODEVICE);
+		return (NODEVICE);
+	}
+
+	return (lcd44780spiattach(copy,0,1));
+}
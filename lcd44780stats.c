@@ -0,0 +1,156 @@
+/******************************************************************************/
+/*                                                                            */
+/* Counters for the HD44780U LCD display library for I2C bus.                 */
+/*                                                                            */
+/* Each display counts its writes to the bus, the bytes they carry, the       */
+/* instructions and data sent to the HD44780U and the set address             */
+/* instructions sent and saved. The time spent in delays, writing and         */
+/* encoding (on the library's clock) is only counted while timing is on (see  */
+/* lcd44780settiming), as reading the clock costs more than the encoding.     */
+/*                                                                            */
+/* Counters are only ever added to with relaxed atomic adds, and              */
+/* lcd44780stats neither adds nor caches state for a display, so it can take  */
+/* a snapshot from another thread at any time while the display is open.      */
+/* lcd44780statsdump must be called from the thread using the display.        */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+#include "lcd44780int.h"
+
+#define STATSCOUNTERS           (sizeof(lcd44780counters)/sizeof(uint64_t))
+
+uint8_t lcd44780timingon=0;			// Time delays, writes, encoding and operations
+
+/* Counters internal library functions */
+
+static void lcd44780statsprint(lcd44780dev *dev, FILE *f) {
+/******************************************************************************/
+/*                                                                            */
+/* Print a display's counters on one line.                                    */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	lcd44780counters c;
+
+	lcd44780stats(dev->pi,dev->fd,&c,0);
+
+	fprintf(f,"lcd44780 %d/%d: %llu writes (%llu failed), %llu bytes, %llu commands, %llu data, "
+		"%llu set address sent, %llu skipped, sleep %.3f ms, bus %.3f ms, encode %.3f ms\n",
+		dev->pi,dev->fd,(unsigned long long)c.sends,(unsigned long long)c.failed,
+		(unsigned long long)c.bytes,(unsigned long long)c.commands,(unsigned long long)c.data,
+		(unsigned long long)c.addrsent,(unsigned long long)c.addrskipped,
+		c.sleepns/1e6,c.busns/1e6,c.encodens/1e6);
+	fflush(f);
+	return;
+}
+
+void lcd44780statsdue(lcd44780dev *dev) {
+/******************************************************************************/
+/*                                                                            */
+/* Dump the counters if it's time to (see lcd44780statsdump) - checked after  */
+/* each write to the bus, so a display that's left alone isn't dumped.        */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	uint64_t now;
+
+	if (dev->statsevery == 0) return;
+
+	now=lcd44780clocknow();
+	if (now < dev->statsdue) return;
+
+	lcd44780statsprint(dev,dev->statsfile);
+	dev->statsdue=now+dev->statsevery;
+	return;
+}
+
+/* Counters external library functions */
+
+int lcd44780stats(int pi, int fd, lcd44780counters *counters, uint8_t reset)
+/******************************************************************************/
+/*                                                                            */
+/* Take a snapshot of a display's counters. If reset is non zero they start   */
+/* again from 0 - nothing counted between the snapshot and the reset is lost. */
+/* A display the library doesn't know yet has counted nothing. Safe to call   */
+/* from another thread while the display is in use (but not being closed).    */
+/*                                                                            */
+/* Returns 0.                                                                 */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+{
+	unsigned count;
+	uint64_t *from,*to;
+	lcd44780dev *dev;
+
+	dev=lcd44780finddev(pi,fd);
+	if (dev == NULL) {
+		memset(counters,0,sizeof(lcd44780counters));
+		return (0);
+	}
+
+	from=(uint64_t *)&dev->stats;
+	to=(uint64_t *)counters;
+	for (count=0;count<STATSCOUNTERS;count++) {
+		if (reset) to[count]=__atomic_exchange_n(&from[count],0,__ATOMIC_RELAXED);
+		else to[count]=__atomic_load_n(&from[count],__ATOMIC_RELAXED);
+	}
+	return (0);
+}
+
+int lcd44780statsdump(int pi, int fd, FILE *f, uint32_t seconds)
+/******************************************************************************/
+/*                                                                            */
+/* Print a display's counters to f now, then (if seconds isn't 0) every       */
+/* seconds while it's in use - the dump is made by the first write to the     */
+/* bus once the time is up. f=NULL stops the dumps.                           */
+/*                                                                            */
+/* Returns 0, or NOMEMORY.                                                    */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+{
+	lcd44780dev *dev;
+
+	dev=lcd44780getdev(pi,fd,1);
+	if (dev == NULL) {
+		lcd44780error_fprintf(NOMEMORY);
+		return (NOMEMORY);
+	}
+
+	dev->statsfile=f;
+	if (f == NULL) return (0);
+
+	lcd44780statsprint(dev,f);
+	dev->statsevery=(uint64_t)seconds*1000000000ULL;
+	dev->statsdue=lcd44780clocknow()+dev->statsevery;
+	return (0);
+}
+
+int lcd44780settiming(uint8_t setting)
+/******************************************************************************/
+/*                                                                            */
+/* Turn timing on (setting non zero) or off (0, as it starts) for every       */
+/* display. While it's on, the time spent in delays, writing to the bus and   */
+/* encoding is added to each display's counters, and lcd44780str, chr,        */
+/* clearline, clear, commit and init are timed for lcd44780latency. While     */
+/* it's off the clock is only read for a USDT probe that is being traced.     */
+/*                                                                            */
+/* Returns 0.                                                                 */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+{
+	__atomic_store_n(&lcd44780timingon,(setting) ? 1 : 0,__ATOMIC_RELAXED);
+	return (0);
+}
@@ -79,6 +79,7 @@ int main() {
 
         /* Clean up and exit */
 
+        lcd44780close(ipi,fdlcd);
         i2c_close(ipi,fdlcd);
         pigpio_stop(ipi);
 
@@ -0,0 +1,159 @@
+/******************************************************************************/
+/*                                                                            */
+/* Bus timing check for the                                                   */
+/* 44780 LCD display library for I2C bus.                                     */
+/*                                                                            */
+/* Runs a fixed set of operations (lcd44780init, str, chr, clearline, clear,  */
+/* home, backlight, setdisplay, defchar, draw, commit and bar) on the         */
+/* simulated display (lcd44780simopen) at each of the usual I2C bus clocks,   */
+/* on the virtual clock, and reports any byte the simulated HD44780U was sent */
+/* before it had finished with the last. The same is done for a display wired */
+/* straight to GPIO lines, by feeding what a mock one (lcd44780gpiomock) sets */
+/* them to into the simulator. No display (or pigpiod) is needed.             */
+/*                                                                            */
+/* Usage: lcd44780timing                                                      */
+/*                                                                            */
+/* Returns 0 if there were no timing violations at any clock, 1 if not.       */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+#include "lcd44780.h"
+#include "lcd44780sim.h"
+
+static const uint32_t clocks[]={100000,400000,1000000};
+#define TIMINGCLOCKS            (sizeof(clocks)/sizeof(clocks[0]))
+
+#define GPIORECORD              6       // Bytes lcd44780gpiomock writes each time the lines are set
+
+static uint8_t gpiomap[8]={2,3,4,5,0,7,1,6};	// Simulator port bit for each GPIO line (R/W tied low)
+
+static void timingops(int pi, int fd) {
+/******************************************************************************/
+/*                                                                            */
+/* Run the operations on a display.                                           */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	int i;
+	uint8_t glyph[8]={0x0E,0x11,0x11,0x1F,0x1B,0x1B,0x1F,0x00};
+
+	lcd44780init(pi,fd,4,20);
+	lcd44780str(pi,fd,"Hello World!",1,5);
+	lcd44780str(pi,fd,"ABCDEFGHIJKLMNOPQRSTUVWXYZ",2,1);
+	lcd44780str(pi,fd,"\xC2\xA3" "5 \xC2\xB0" "C",3,15);
+	lcd44780chr(pi,fd,"A",4,1);
+	lcd44780chr(pi,fd,"\xC3\xA9",4,20);
+	lcd44780clearline(pi,fd,2,10);
+	lcd44780backlight(pi,fd,0);
+	lcd44780backlight(pi,fd,1);
+	lcd44780setdisplay(pi,fd,1,1,1);
+	lcd44780home(pi,fd);
+	lcd44780clear(pi,fd);
+	lcd44780defchar(pi,fd,0,glyph);
+	for (i=0;i<10;i++) {
+		lcd44780draw(pi,fd,(i%2) ? "tick" : "tock",1,1);
+		lcd44780commit(pi,fd);
+		lcd44780bar(pi,fd,LCD44780BARRIGHT,2,1,20,i*10,100);
+	}
+	lcd44780str(pi,fd,"after clear",1,1);
+	return;
+}
+
+static int timingrun(uint32_t hz) {
+/******************************************************************************/
+/*                                                                            */
+/* Run the operations on a simulated display on a bus clocked at hz. Returns  */
+/* the timing violations seen, or -1 if the display can't be opened.          */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	int pi=LCD44780NOPI, fd;
+	uint32_t violations;
+
+	fd=lcd44780simopen(hz);
+	if (fd < 0) return (-1);
+
+	timingops(pi,fd);
+
+	violations=lcd44780simreport(lcd44780simget(fd),stdout);
+	lcd44780close(pi,fd);
+	return ((int)violations);
+}
+
+static int timinggpio(void) {
+/******************************************************************************/
+/*                                                                            */
+/* Run the operations on a mock 4 bit GPIO display, then feed each setting of */
+/* its lines into the simulator at the time it was made. Returns the timing   */
+/* violations seen, or -1 if the mock can't be opened.                        */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	int pi=LCD44780NOPI, fd;
+	uint8_t record[GPIORECORD];
+	uint64_t ns=0;
+	FILE *t;
+	lcd44780sim sim;
+
+	t=tmpfile();
+	if (t == NULL) return (-1);
+
+	fd=lcd44780gpiomock(fileno(t),4);
+	if (fd < 0) {
+		fclose(t);
+		return (-1);
+	}
+
+	timingops(pi,fd);
+	lcd44780close(pi,fd);
+
+	lcd44780simreset(&sim,gpiomap);
+	rewind(t);
+	while (fread(record,GPIORECORD,1,t) == 1) {
+		ns+=record[0]|(record[1]<<8)|(record[2]<<16)|((uint64_t)record[3]<<24);
+		lcd44780simwrite(&sim,record[4],ns);
+	}
+	fclose(t);
+
+	return ((int)lcd44780simreport(&sim,stdout));
+}
+
+int main(int argc, char *argv[]) {
+	int failed=0, violations;
+	unsigned c;
+
+	if (argc > 1) {
+		fprintf(stderr,"Usage: %s\n",argv[0]);
+		exit(1);
+	}
+
+	lcd44780setclock(LCD44780CLOCKVIRTUAL);
+
+	for (c=0;c<TIMINGCLOCKS;c++) {
+		printf("%7u Hz  ",clocks[c]);
+		fflush(stdout);
+		violations=timingrun(clocks[c]);
+		if (violations < 0) {
+			fprintf(stderr,"Can't open the simulated display\n");
+			exit(1);
+		}
+		if (violations == 0) printf("no timing violations\n");
+		else failed=1;
+	}
+
+	printf("%10s  ","gpio");
+	fflush(stdout);
+	violations=timinggpio();
+	if (violations < 0) {
+		fprintf(stderr,"Can't open the mock GPIO display\n");
+		exit(1);
+	}
+	if (violations == 0) printf("no timing violations\n");
+	else failed=1;
+
+	exit(failed);
+}
@@ -0,0 +1,228 @@
+/******************************************************************************/
+/*                                                                            */
+/* Bus trace for the HD44780U LCD display library for I2C bus.                */
+/*                                                                            */
+/* While tracing is on (lcd44780trace), every write to the bus and every      */
+/* delay is recorded in a ring buffer - when it started, how long it took,    */
+/* the display, the bytes written and what they carried for the HD44780U.     */
+/* Writers claim entries with an atomic add, so displays on different         */
+/* threads never wait for each other, and lcd44780traceexport can be called   */
+/* at any time to write the ring out as Chrome trace event JSON, for viewing  */
+/* in Perfetto (ui.perfetto.dev) or chrome://tracing. With tracing off, each  */
+/* place that records costs one test of lcd44780tracering.                    */
+/*                                                                            */
+/* Times are on the library's clock - CLOCK_MONOTONIC unless the virtual      */
+/* clock is in use - so they line up with other traces taken on the same      */
+/* machine.                                                                   */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+#include "lcd44780int.h"
+
+#define TRACEMAX                (1<<24) // Most entries a ring may have
+
+lcd44780tracebuf *lcd44780tracering=NULL;	// Ring in use, or NULL when not tracing
+
+/* Trace internal library functions */
+
+void lcd44780tracequeue(lcd44780dev *dev, uint8_t rs, uint8_t *src, int len) {
+/******************************************************************************/
+/*                                                                            */
+/* Note what's been queued for the display, for the trace entry of the write  */
+/* that sends it.                                                             */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	int count;
+
+	if (rs) {
+		dev->tracedata+=len;
+		return;
+	}
+
+	dev->tracecmds+=len;
+	for (count=0;count<len;count++)
+		if (src[count] & (DDRAMSETADDR|CGRAMSETADDR)) dev->traceaddrs++;
+	return;
+}
+
+void lcd44780traceadd(lcd44780dev *dev, uint8_t type, uint64_t at, uint64_t ns, uint32_t bytes, int result) {
+/******************************************************************************/
+/*                                                                            */
+/* Record a write to the bus (TRACESEND) or a delay (TRACESLEEP) in the ring. */
+/* The entry's seq is cleared while it's filled in, so a reader never takes   */
+/* half of one entry and half of another.                                     */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	uint64_t seq;
+	lcd44780tracebuf *ring;
+	lcd44780traceentry *e;
+
+	ring=__atomic_load_n(&lcd44780tracering,__ATOMIC_ACQUIRE);
+	if (ring == NULL) return;
+
+	seq=__atomic_fetch_add(&ring->head,1,__ATOMIC_RELAXED);
+	e=&ring->entry[seq&ring->mask];
+
+	__atomic_store_n(&e->seq,0,__ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	e->at=at;
+	e->ns=ns;
+	e->pi=dev->pi;
+	e->fd=dev->fd;
+	e->type=type;
+	e->bytes=bytes;
+	e->result=result;
+	if (type == TRACESEND) {
+		e->commands=dev->tracecmds;
+		e->addrs=dev->traceaddrs;
+		e->data=dev->tracedata;
+		dev->tracecmds=dev->traceaddrs=dev->tracedata=0;
+	}
+	else e->commands=e->addrs=e->data=0;
+
+	__atomic_store_n(&e->seq,seq+1,__ATOMIC_RELEASE);
+	return;
+}
+
+static void lcd44780tracename(lcd44780traceentry *e, char *name) {
+/******************************************************************************/
+/*                                                                            */
+/* Name an entry by what it did - sleep, or what the write carried, e.g.      */
+/* "set-address+data" (just "write" for a write carrying none of them, such   */
+/* as the backlight being switched).                                          */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	name[0]='\0';
+
+	if (e->type == TRACESLEEP) {
+		strcpy(name,"sleep");
+		return;
+	}
+
+	if (e->commands > e->addrs) strcat(name,"cmd");
+	if (e->addrs > 0) strcat(name,(name[0] == '\0') ? "set-address" : "+set-address");
+	if (e->data > 0) strcat(name,(name[0] == '\0') ? "data" : "+data");
+	if (name[0] == '\0') strcpy(name,"write");
+	return;
+}
+
+/* Trace external library functions */
+
+int lcd44780trace(uint32_t entries)
+/******************************************************************************/
+/*                                                                            */
+/* Start tracing into a ring of at least entries entries (rounded up to a     */
+/* power of 2, up to 16M) - each about 48 bytes - throwing away anything      */
+/* traced before. entries=0 stops tracing. Only call it while no display is   */
+/* being written to - the ring it replaces is freed.                          */
+/*                                                                            */
+/* Returns 0, NOMEMORY, or BADSETTING if entries is too big.                  */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+{
+	uint64_t size=1;
+	lcd44780tracebuf *ring=NULL,*old;
+
+	if (entries > TRACEMAX) {
+		lcd44780error_fprintf(BADSETTING);
+		return (BADSETTING);
+	}
+
+	if (entries > 0) {
+		while (size < entries) size<<=1;
+		ring=calloc(1,sizeof(lcd44780tracebuf)+size*sizeof(lcd44780traceentry));
+		if (ring == NULL) {
+			lcd44780error_fprintf(NOMEMORY);
+			return (NOMEMORY);
+		}
+		ring->mask=size-1;
+	}
+
+	old=__atomic_exchange_n(&lcd44780tracering,ring,__ATOMIC_ACQ_REL);
+	free(old);
+	return (0);
+}
+
+int lcd44780traceexport(FILE *f)
+/******************************************************************************/
+/*                                                                            */
+/* Write the ring, oldest first, to f as a Chrome trace event JSON file.      */
+/* Each write and delay is a complete ("X") event, named by what it did (see  */
+/* lcd44780tracename) with its byte and instruction counts as args, on a      */
+/* track of its own for each display. Entries being written as the ring is    */
+/* read are left out. Tracing carries on.                                     */
+/*                                                                            */
+/* Returns the number of events written (0 if tracing is off).                */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+{
+	int written=0,named=0,count;
+	int32_t tracks[MAXDEVS][2];
+	char name[32];
+	uint64_t seq,head,first;
+	long tid;
+	pid_t pid;
+	lcd44780tracebuf *ring;
+	lcd44780traceentry e,*slot;
+
+	pid=getpid();
+	fprintf(f,"{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+
+	ring=__atomic_load_n(&lcd44780tracering,__ATOMIC_ACQUIRE);
+	if (ring != NULL) {
+		head=__atomic_load_n(&ring->head,__ATOMIC_ACQUIRE);
+		first=(head > ring->mask+1) ? head-ring->mask-1 : 0;
+
+		for (seq=first;seq<head;seq++) {
+			slot=&ring->entry[seq&ring->mask];
+			if (__atomic_load_n(&slot->seq,__ATOMIC_ACQUIRE) != seq+1) continue;
+			e=*slot;
+			__atomic_thread_fence(__ATOMIC_ACQUIRE);
+			if (__atomic_load_n(&slot->seq,__ATOMIC_RELAXED) != seq+1) continue;
+
+			tid=((long)(e.pi+1)<<16)|e.fd;	// A track for each display
+
+			for (count=0;count<named;count++)
+				if ((tracks[count][0] == e.pi) && (tracks[count][1] == e.fd)) break;
+			if ((count == named) && (named < MAXDEVS)) {
+				tracks[named][0]=e.pi;
+				tracks[named][1]=e.fd;
+				named++;
+				fprintf(f,"%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%ld,"
+					"\"args\":{\"name\":\"lcd44780 pi %d fd %d\"}}",
+					(written++ == 0) ? "" : ",\n",(int)pid,tid,e.pi,e.fd);
+			}
+
+			lcd44780tracename(&e,name);
+			fprintf(f,"%s{\"name\":\"%s\",\"cat\":\"lcd44780\",\"ph\":\"X\",\"pid\":%d,\"tid\":%ld,"
+				"\"ts\":%llu.%03llu,\"dur\":%llu.%03llu,\"args\":{\"bytes\":%u,\"commands\":%u,"
+				"\"setaddress\":%u,\"data\":%u,\"result\":%d}}",
+				(written++ == 0) ? "" : ",\n",name,(int)pid,tid,
+				(unsigned long long)(e.at/1000),(unsigned long long)(e.at%1000),
+				(unsigned long long)(e.ns/1000),(unsigned long long)(e.ns%1000),
+				e.bytes,e.commands,e.addrs,e.data,e.result);
+		}
+	}
+
+	fprintf(f,"\n]}\n");
+	fflush(f);
+	return (written-named);
+}
@@ -0,0 +1,300 @@
+/******************************************************************************/
+/*                                                                            */
+/* UTF-8 support for the HD44780U LCD display library for I2C bus.            */
+/*                                                                            */
+/* Strings are decoded from UTF-8 and each character translated to the code   */
+/* the display's character ROM uses for it, with one table lookup. Two ROMs   */
+/* are supported - A00 (Japanese, the usual one) and A02 (European). A        */
+/* character the ROM doesn't have is drawn from a small built in font into    */
+/* CGRAM the first time it's needed, if it is in the font and a slot is free, */
+/* otherwise it is shown as REPLACEMENT.                                      */
+/*                                                                            */
+/* ASCII (0x00-0x7F) is always sent unchanged, so existing strings - and      */
+/* CGRAM codes 0x00-0x0F - behave as they always have. Bytes that aren't      */
+/* valid UTF-8, like "\xDF" written for the A00 degree sign, are also sent    */
+/* unchanged.                                                                 */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+#include "lcd44780int.h"
+#include "lcd44780rec.h"
+
+#define REPLACEMENT     '?'     // Shown for characters the display can't draw
+#define RAWBYTE         0x110000 // Added to a byte that isn't valid UTF-8 (beyond Unicode)
+
+/* Built in font for characters missing from a ROM. In the ROM tables an      */
+/* entry of 1 to SYNTHGLYPHS means "use synthfont[entry-1]"; 0 means the      */
+/* character can't be drawn; anything else is the ROM code.                   */
+
+static const uint8_t synthfont[SYNTHGLYPHS][8]={
+	{0x06,0x09,0x08,0x1E,0x08,0x08,0x1F,0x00},	// 1 £
+	{0x07,0x08,0x1E,0x08,0x1E,0x08,0x07,0x00},	// 2 €
+	{0x0A,0x00,0x0E,0x11,0x1F,0x11,0x11,0x00},	// 3 Ä
+	{0x0A,0x00,0x0E,0x11,0x11,0x11,0x0E,0x00},	// 4 Ö
+	{0x0A,0x00,0x11,0x11,0x11,0x11,0x0E,0x00},	// 5 Ü
+	{0x08,0x04,0x0E,0x01,0x0F,0x11,0x0F,0x00},	// 6 à
+	{0x00,0x0E,0x10,0x10,0x11,0x0E,0x04,0x0C},	// 7 ç
+	{0x08,0x04,0x0E,0x11,0x1F,0x10,0x0E,0x00},	// 8 è
+	{0x02,0x04,0x0E,0x11,0x1F,0x10,0x0E,0x00}};	// 9 é
+
+/* A00 ROM. Tables are indexed by the low byte of the code point, and         */
+/* picked by the high byte from a00pages.                                     */
+
+static const uint8_t a00p00[256]={				// Latin-1
+	[0xA2]=0xEC,[0xA3]=1,[0xA5]=0x5C,[0xB0]=0xDF,[0xB5]=0xE4,[0xB7]=0xA5,
+	[0xC4]=3,[0xD6]=4,[0xDC]=5,[0xDF]=0xE2,[0xE0]=6,[0xE4]=0xE1,
+	[0xE7]=7,[0xE8]=8,[0xE9]=9,[0xF1]=0xEE,[0xF6]=0xEF,[0xF7]=0xFD,
+	[0xFC]=0xF5};
+
+static const uint8_t a00p03[256]={				// Greek
+	[0xA3]=0xF6,[0xA9]=0xF4,[0xB1]=0xE0,[0xB2]=0xE2,[0xB5]=0xE3,[0xB8]=0xF2,
+	[0xBC]=0xE4,[0xC0]=0xF7,[0xC1]=0xE6,[0xC3]=0xE5};
+
+static const uint8_t a00p20[256]={				// Punctuation
+	[0xAC]=2};
+
+static const uint8_t a00p21[256]={				// Arrows
+	[0x90]=0x7F,[0x92]=0x7E};
+
+static const uint8_t a00p22[256]={				// Mathematical operators
+	[0x1A]=0xE8,[0x1E]=0xF3};
+
+static const uint8_t a00p25[256]={				// Block elements
+	[0x88]=0xFF};
+
+static const uint8_t a00p30[256]={				// Japanese punctuation and katakana
+	[0x01]=0xA4,[0x02]=0xA1,[0x0C]=0xA2,[0x0D]=0xA3,[0x99]=0xDE,[0x9A]=0xDF,
+	[0x9B]=0xDE,[0x9C]=0xDF,[0xA1]=0xA7,[0xA2]=0xB1,[0xA3]=0xA8,[0xA4]=0xB2,
+	[0xA5]=0xA9,[0xA6]=0xB3,[0xA7]=0xAA,[0xA8]=0xB4,[0xA9]=0xAB,[0xAA]=0xB5,
+	[0xAB]=0xB6,[0xAD]=0xB7,[0xAF]=0xB8,[0xB1]=0xB9,[0xB3]=0xBA,[0xB5]=0xBB,
+	[0xB7]=0xBC,[0xB9]=0xBD,[0xBB]=0xBE,[0xBD]=0xBF,[0xBF]=0xC0,[0xC1]=0xC1,
+	[0xC3]=0xAF,[0xC4]=0xC2,[0xC6]=0xC3,[0xC8]=0xC4,[0xCA]=0xC5,[0xCB]=0xC6,
+	[0xCC]=0xC7,[0xCD]=0xC8,[0xCE]=0xC9,[0xCF]=0xCA,[0xD2]=0xCB,[0xD5]=0xCC,
+	[0xD8]=0xCD,[0xDB]=0xCE,[0xDE]=0xCF,[0xDF]=0xD0,[0xE0]=0xD1,[0xE1]=0xD2,
+	[0xE2]=0xD3,[0xE3]=0xAC,[0xE4]=0xD4,[0xE5]=0xAD,[0xE6]=0xD5,[0xE7]=0xAE,
+	[0xE8]=0xD6,[0xE9]=0xD7,[0xEA]=0xD8,[0xEB]=0xD9,[0xEC]=0xDA,[0xED]=0xDB,
+	[0xEF]=0xDC,[0xF2]=0xA6,[0xF3]=0xDD,[0xFB]=0xA5,[0xFC]=0xB0};
+
+static const uint8_t a00p4e[256]={[0x07]=0xFB};			// 万
+static const uint8_t a00p51[256]={[0x86]=0xFC};			// 円
+static const uint8_t a00p53[256]={[0x43]=0xFA};			// 千
+
+static const uint8_t a00pff[256]={				// Halfwidth katakana
+	[0x61]=0xA1,[0x62]=0xA2,[0x63]=0xA3,[0x64]=0xA4,[0x65]=0xA5,[0x66]=0xA6,
+	[0x67]=0xA7,[0x68]=0xA8,[0x69]=0xA9,[0x6A]=0xAA,[0x6B]=0xAB,[0x6C]=0xAC,
+	[0x6D]=0xAD,[0x6E]=0xAE,[0x6F]=0xAF,[0x70]=0xB0,[0x71]=0xB1,[0x72]=0xB2,
+	[0x73]=0xB3,[0x74]=0xB4,[0x75]=0xB5,[0x76]=0xB6,[0x77]=0xB7,[0x78]=0xB8,
+	[0x79]=0xB9,[0x7A]=0xBA,[0x7B]=0xBB,[0x7C]=0xBC,[0x7D]=0xBD,[0x7E]=0xBE,
+	[0x7F]=0xBF,[0x80]=0xC0,[0x81]=0xC1,[0x82]=0xC2,[0x83]=0xC3,[0x84]=0xC4,
+	[0x85]=0xC5,[0x86]=0xC6,[0x87]=0xC7,[0x88]=0xC8,[0x89]=0xC9,[0x8A]=0xCA,
+	[0x8B]=0xCB,[0x8C]=0xCC,[0x8D]=0xCD,[0x8E]=0xCE,[0x8F]=0xCF,[0x90]=0xD0,
+	[0x91]=0xD1,[0x92]=0xD2,[0x93]=0xD3,[0x94]=0xD4,[0x95]=0xD5,[0x96]=0xD6,
+	[0x97]=0xD7,[0x98]=0xD8,[0x99]=0xD9,[0x9A]=0xDA,[0x9B]=0xDB,[0x9C]=0xDC,
+	[0x9D]=0xDD,[0x9E]=0xDE,[0x9F]=0xDF};
+
+static const uint8_t *const a00pages[256]={
+	[0x00]=a00p00,[0x03]=a00p03,[0x20]=a00p20,[0x21]=a00p21,[0x22]=a00p22,
+	[0x25]=a00p25,[0x30]=a00p30,[0x4E]=a00p4e,[0x51]=a00p51,[0x53]=a00p53,
+	[0xFF]=a00pff};
+
+/* A02 ROM. The top half of the ROM follows Latin-1. */
+
+static const uint8_t a02p00[256]={				// Latin-1
+	[0xA1]=0xA1,[0xA2]=0xA2,[0xA3]=0xA3,[0xA4]=0xA4,[0xA5]=0xA5,[0xA6]=0xA6,
+	[0xA7]=0xA7,[0xA8]=0xA8,[0xA9]=0xA9,[0xAA]=0xAA,[0xAB]=0xAB,[0xAC]=0xAC,
+	[0xAD]=0xAD,[0xAE]=0xAE,[0xAF]=0xAF,[0xB0]=0xB0,[0xB1]=0xB1,[0xB2]=0xB2,
+	[0xB3]=0xB3,[0xB4]=0xB4,[0xB5]=0xB5,[0xB6]=0xB6,[0xB7]=0xB7,[0xB8]=0xB8,
+	[0xB9]=0xB9,[0xBA]=0xBA,[0xBB]=0xBB,[0xBC]=0xBC,[0xBD]=0xBD,[0xBE]=0xBE,
+	[0xBF]=0xBF,[0xC0]=0xC0,[0xC1]=0xC1,[0xC2]=0xC2,[0xC3]=0xC3,[0xC4]=0xC4,
+	[0xC5]=0xC5,[0xC6]=0xC6,[0xC7]=0xC7,[0xC8]=0xC8,[0xC9]=0xC9,[0xCA]=0xCA,
+	[0xCB]=0xCB,[0xCC]=0xCC,[0xCD]=0xCD,[0xCE]=0xCE,[0xCF]=0xCF,[0xD0]=0xD0,
+	[0xD1]=0xD1,[0xD2]=0xD2,[0xD3]=0xD3,[0xD4]=0xD4,[0xD5]=0xD5,[0xD6]=0xD6,
+	[0xD7]=0xD7,[0xD8]=0xD8,[0xD9]=0xD9,[0xDA]=0xDA,[0xDB]=0xDB,[0xDC]=0xDC,
+	[0xDD]=0xDD,[0xDE]=0xDE,[0xDF]=0xDF,[0xE0]=0xE0,[0xE1]=0xE1,[0xE2]=0xE2,
+	[0xE3]=0xE3,[0xE4]=0xE4,[0xE5]=0xE5,[0xE6]=0xE6,[0xE7]=0xE7,[0xE8]=0xE8,
+	[0xE9]=0xE9,[0xEA]=0xEA,[0xEB]=0xEB,[0xEC]=0xEC,[0xED]=0xED,[0xEE]=0xEE,
+	[0xEF]=0xEF,[0xF0]=0xF0,[0xF1]=0xF1,[0xF2]=0xF2,[0xF3]=0xF3,[0xF4]=0xF4,
+	[0xF5]=0xF5,[0xF6]=0xF6,[0xF7]=0xF7,[0xF8]=0xF8,[0xF9]=0xF9,[0xFA]=0xFA,
+	[0xFB]=0xFB,[0xFC]=0xFC,[0xFD]=0xFD,[0xFE]=0xFE,[0xFF]=0xFF};
+
+static const uint8_t a02p20[256]={				// Punctuation
+	[0xAC]=2};
+
+static const uint8_t *const a02pages[256]={
+	[0x00]=a02p00,[0x20]=a02p20};
+
+/* UTF-8 internal library functions */
+
+static int lcd44780utf8decode(const char *src, int avail, uint32_t *cp) {
+/******************************************************************************/
+/*                                                                            */
+/* Decode one character from the first avail (at least 1) bytes of a UTF-8    */
+/* string into *cp, returning the number of bytes used. A byte that doesn't   */
+/* start a valid, shortest form sequence within avail bytes is returned on    */
+/* its own as RAWBYTE plus the byte.                                          */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	const uint8_t *s=(const uint8_t *)src;
+	uint32_t c;
+	int count,len;
+
+	if (s[0] < 0x80) {
+		*cp=s[0];
+		return(1);
+	}
+
+	if ((s[0] >= 0xC2) && (s[0] <= 0xDF)) {
+		len=2;
+		c=s[0]&0x1F;
+	}
+	else if ((s[0] >= 0xE0) && (s[0] <= 0xEF)) {
+		len=3;
+		c=s[0]&0x0F;
+	}
+	else if ((s[0] >= 0xF0) && (s[0] <= 0xF4)) {
+		len=4;
+		c=s[0]&0x07;
+	}
+	else {
+		*cp=RAWBYTE+s[0];
+		return(1);
+	}
+
+	for (count=1;count<len;count++) {			// Stops at the terminator too
+		if ((count >= avail) || ((s[count]&0xC0) != 0x80)) {
+			*cp=RAWBYTE+s[0];
+			return(1);
+		}
+		c=(c<<6)|(s[count]&0x3F);
+	}
+
+	if (((len == 3) && ((c < 0x800) || ((c >= 0xD800) && (c <= 0xDFFF)))) ||
+	    ((len == 4) && ((c < 0x10000) || (c > 0x10FFFF)))) {
+		*cp=RAWBYTE+s[0];				// Overlong or surrogate
+		return(1);
+	}
+
+	*cp=c;
+	return(len);
+}
+
+static uint8_t lcd44780romcode(lcd44780dev *dev, uint32_t cp) {
+/******************************************************************************/
+/*                                                                            */
+/* Character code to send for code point cp on this display's ROM.            */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	const uint8_t *page;
+	uint8_t code;
+	int slot;
+
+	if (cp < 0x80) return(lcd44780glyphmap(dev,cp));
+	if (cp >= RAWBYTE) return(cp-RAWBYTE);
+	if (cp > 0xFFFF) return(REPLACEMENT);
+
+	page=(dev->rom == LCD44780ROMA02) ? a02pages[cp>>8] : a00pages[cp>>8];
+	code=(page != NULL) ? page[cp&0xFF] : 0;
+
+	if (code > SYNTHGLYPHS) return(code);			// In the ROM
+	if (code == 0) return(REPLACEMENT);
+
+	if (dev->synth[code-1] < 0) {				// Draw it into CGRAM
+		slot=lcd44780loadglyph(dev,(uint8_t *)synthfont[code-1]);
+		if (slot < 0) return(REPLACEMENT);
+		dev->synth[code-1]=slot;
+	}
+	return(dev->synth[code-1]);
+}
+
+int lcd44780utf8len(lcd44780dev *dev, char *src) {
+/******************************************************************************/
+/*                                                                            */
+/* Number of bytes in the first character of a string - 0 if it's empty. No   */
+/* byte is read beyond the first that can't be part of the character, so a    */
+/* single ASCII byte needn't be terminated.                                   */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	uint32_t cp;
+
+	if (*src == '\0') return(0);
+	if (dev->rom == LCD44780ROMRAW) return(1);
+	return(lcd44780utf8decode(src,4,&cp));
+}
+
+int lcd44780utf8cells(lcd44780dev *dev, char *src, int srclen, uint8_t *cells, int maxcells) {
+/******************************************************************************/
+/*                                                                            */
+/* Translate up to maxcells characters from the first srclen bytes of a       */
+/* string (UTF8TERMINATED for all of it) into the codes to send to the        */
+/* display, stopping at the terminator. Returns the number of cells. With the */
+/* ROM set to LCD44780ROMRAW, bytes are copied as they are.                   */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	int count=0,used;
+	uint32_t cp;
+
+	while ((count < maxcells) && (srclen > 0) && (*src != '\0')) {
+		if (dev->rom == LCD44780ROMRAW) {
+			cells[count++]=lcd44780glyphmap(dev,*src++);
+			srclen--;
+			continue;
+		}
+		used=lcd44780utf8decode(src,srclen,&cp);
+		src+=used;
+		srclen-=used;
+		cells[count++]=lcd44780romcode(dev,cp);
+	}
+
+	return(count);
+}
+
+/* UTF-8 external library functions */
+
+int lcd44780setrom(int pi, int fd, uint8_t rom)
+/******************************************************************************/
+/*                                                                            */
+/* Say which character ROM the display has, for translating UTF-8 strings:    */
+/* LCD44780ROMA00 (Japanese, the default), LCD44780ROMA02 (European) or       */
+/* LCD44780ROMRAW to send the bytes of every string unchanged.                */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+{
+	int args[1];
+	lcd44780dev *dev;
+
+	dev=lcd44780getdev(pi,fd,1);
+	if (dev == NULL) {
+		lcd44780error_fprintf(NOMEMORY);
+		return (NOMEMORY);
+	}
+
+	if (rom > LCD44780ROMRAW) {
+		lcd44780error_fprintf(BADSETTING);
+		return (BADSETTING);
+	}
+
+	args[0]=rom;
+	lcd44780reccall(dev,RECSETROM,1,args,NULL,0);
+	dev->rom=rom;
+	lcd44780recend(dev,0);
+	return (0);
+}
@@ -0,0 +1,206 @@
+/******************************************************************************/
+/*                                                                            */
+/* Pin level capture for the HD44780U LCD display library for I2C bus.        */
+/*                                                                            */
+/* While a display is being captured (lcd44780vcd), every byte written to     */
+/* its port expander is turned into changes of the RS, RW, E, BL and D4-D7    */
+/* lines and written to a Value Change Dump file, for viewing in GTKWave      */
+/* against the data sheet's timing diagrams. Each byte is put at its share of */
+/* the write that sent it (after the I2C address byte), on the library's      */
+/* clock - real, or virtual with the simulator. A private simulated HD44780U  */
+/* follows the lines so every instruction and data write can be decoded into  */
+/* a string signal ("transfer") as E falls.                                   */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+#include "lcd44780int.h"
+#include "lcd44780sim.h"
+
+#define VCDLINES                8       // RS, RW, E, BL, D4-D7 - in lcd44780sim map order below
+
+// Capture of one display
+
+typedef struct lcd44780capture {
+	FILE *f;				// VCD file being written
+	uint64_t start;				// Time of #0
+	uint64_t last;				// Time of the last change written
+	int port;				// Last byte written to the port, or -1 before the first
+	lcd44780sim sim;			// Follows the lines to decode each transfer
+} lcd44780capture;
+
+static const char vcdid[VCDLINES]={'%','&','\'','(','!','"','#','$'};	// Indexed as lcd44780sim map
+static const char *vcdname[VCDLINES]={"D4","D5","D6","D7","RS","RW","E","BL"};
+
+/* Pin capture internal library functions */
+
+static void lcd44780vcddecode(uint8_t rs, uint8_t data, char *text) {
+/******************************************************************************/
+/*                                                                            */
+/* Name an instruction or data write, without spaces (as VCD strings can't    */
+/* hold them), e.g. "cmd:set-ddram:0x40" or "data:0x48".                      */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	if (rs) sprintf(text,"data:0x%02X",data);
+	else if (data & DDRAMSETADDR) sprintf(text,"cmd:set-ddram:0x%02X",data&0x7F);
+	else if (data & CGRAMSETADDR) sprintf(text,"cmd:set-cgram:0x%02X",data&0x3F);
+	else if (data & FUNCTIONSET) sprintf(text,"cmd:function-set:0x%02X",data);
+	else if (data & CURSORMOVE) sprintf(text,"cmd:shift:0x%02X",data);
+	else if (data & DISPLAYCONTROL) sprintf(text,"cmd:display-control:0x%02X",data);
+	else if (data & ENTRYMODESET) sprintf(text,"cmd:entry-mode:0x%02X",data);
+	else if (data & CURSORHOME) strcpy(text,"cmd:home");
+	else if (data & CLEARDISPLAY) strcpy(text,"cmd:clear");
+	else strcpy(text,"cmd:0x00");
+	return;
+}
+
+static void lcd44780vcdbyte(lcd44780capture *vcd, uint8_t byte, uint64_t t) {
+/******************************************************************************/
+/*                                                                            */
+/* Write the line changes made by a byte written to the port at time t, and   */
+/* what was transferred if E fell.                                            */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	int line,value,changed=0;
+	uint32_t taken;
+	char text[32];
+
+	if (t < vcd->last) t=vcd->last;		// Time never goes back in a VCD file
+
+	for (line=0;line<VCDLINES;line++) {
+		value=(byte>>vcd->sim.map[line])&1;
+		if ((vcd->port >= 0) && (((vcd->port>>vcd->sim.map[line])&1) == value)) continue;
+		if (changed++ == 0) fprintf(vcd->f,"#%llu\n",(unsigned long long)(t-vcd->start));
+		fprintf(vcd->f,"%d%c\n",value,vcdid[line]);
+	}
+
+	if (changed) {
+		fprintf(vcd->f,"b%d%d%d%d )\n",(byte>>vcd->sim.map[SIMD7])&1,(byte>>vcd->sim.map[SIMD6])&1,
+			(byte>>vcd->sim.map[SIMD5])&1,(byte>>vcd->sim.map[SIMD4])&1);
+		vcd->last=t;
+	}
+
+	taken=vcd->sim.instructions+vcd->sim.writes;
+	lcd44780simwrite(&vcd->sim,byte,t-vcd->start);
+	if (vcd->sim.instructions+vcd->sim.writes != taken) {
+		lcd44780vcddecode(vcd->sim.lastrs,vcd->sim.lastdata,text);
+		fprintf(vcd->f,"s%s *\n",text);
+	}
+
+	vcd->port=byte;
+	return;
+}
+
+void lcd44780vcdframe(lcd44780dev *dev, uint64_t start, uint64_t ns) {
+/******************************************************************************/
+/*                                                                            */
+/* Capture the bytes queued for the display, written to the bus from start    */
+/* for ns nanoseconds - each one placed at its share of the write, the I2C    */
+/* address byte taking the first share.                                       */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	int count;
+
+	for (count=0;count<dev->outlen;count++)
+		lcd44780vcdbyte(dev->vcd,dev->out[count],start+ns*(count+1)/(dev->outlen+1));
+	return;
+}
+
+void lcd44780vcdend(lcd44780dev *dev) {
+/******************************************************************************/
+/*                                                                            */
+/* Finish a display's capture - the file is left open for the caller.         */
+/*                                                                            */
+/* Internal library function only.                                            */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+	uint64_t now;
+
+	if (dev->vcd == NULL) return;
+
+	now=lcd44780clocknow();
+	if (now < dev->vcd->last) now=dev->vcd->last;
+	fprintf(dev->vcd->f,"#%llu\n",(unsigned long long)(now-dev->vcd->start));
+	fflush(dev->vcd->f);
+
+	free(dev->vcd);
+	dev->vcd=NULL;
+	return;
+}
+
+/* Pin capture external library functions */
+
+int lcd44780vcd(int pi, int fd, FILE *f)
+/******************************************************************************/
+/*                                                                            */
+/* Start capturing the display's pins to f as a VCD file, or stop if f is     */
+/* NULL (f is flushed but not closed - lcd44780close stops a capture too).    */
+/* The display must be on a backpack that writes whole bytes to one port -    */
+/* PCF8574, MCP23008, the RGB plate, the simulator or pigpiod's socket.       */
+/*                                                                            */
+/* Returns 0, NOMEMORY, or BADSETTING if the backpack has no such port.       */
+/*                                                                            */
+/* (c) Tim Holyoake, 16th October 2026.                                       */
+/*                                                                            */
+/******************************************************************************/
+{
+	int line;
+	time_t now;
+	lcd44780dev *dev;
+	lcd44780capture *vcd;
+
+	dev=lcd44780getdev(pi,fd,1);
+	if (dev == NULL) {
+		lcd44780error_fprintf(NOMEMORY);
+		return (NOMEMORY);
+	}
+
+	lcd44780flush(dev);			// Anything queued went before the capture
+	lcd44780vcdend(dev);
+	if (f == NULL) return (0);
+
+	if (dev->drv->encode != lcd44780queuestrobes) {
+		lcd44780error_fprintf(BADSETTING);
+		return (BADSETTING);
+	}
+
+	vcd=malloc(sizeof(lcd44780capture));
+	if (vcd == NULL) {
+		lcd44780error_fprintf(NOMEMORY);
+		return (NOMEMORY);
+	}
+
+	vcd->f=f;
+	vcd->start=vcd->last=lcd44780clocknow();
+	vcd->port=-1;
+
+	lcd44780simreset(&vcd->sim,(uint8_t *)&dev->pins);	// d4-bl are in lcd44780sim map order
+	vcd->sim.checking=0;
+	if (dev->rows != 0) vcd->sim.eightbit=0;		// Already in 4 bit mode after lcd44780init
+
+	time(&now);
+	fprintf(f,"$date %.24s $end\n$version lcd44780 $end\n$timescale 1ns $end\n",ctime(&now));
+	fprintf(f,"$comment display pi %d fd %d $end\n$scope module lcd44780 $end\n",pi,fd);
+	for (line=0;line<VCDLINES;line++) fprintf(f,"$var wire 1 %c %s $end\n",vcdid[line],vcdname[line]);
+	fprintf(f,"$var wire 4 ) D[7:4] $end\n$var string 1 * transfer $end\n");
+	fprintf(f,"$upscope $end\n$enddefinitions $end\n#0\n$dumpvars\n");
+	for (line=0;line<VCDLINES;line++) fprintf(f,"x%c\n",vcdid[line]);
+	fprintf(f,"bxxxx )\ns- *\n$end\n");
+
+	dev->vcd=vcd;
+	return (0);
+}